@@ -0,0 +1,239 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+// Efectos de sonido con poca latencia. SDL_mixer sigue abriendo el dispositivo y tocando la musica, pero
+// los efectos los mezcla este motor en el callback de post-mezcla (Mix_SetPostMix), que corre en el hilo
+// de audio. El juego no llama a Mix_PlayChannel: deja comandos en una cola sin locks (un productor, un
+// consumidor) y el callback los saca al empezar cada bloque.
+// Cada comando dice en que muestra del dispositivo empieza el sonido: el momento del rebote en la fisica
+// mas un adelanto fijo, asi todos los golpes suenan con la misma demora y no redondeados al bloque.
+// Cada efecto tiene un maximo de voces; si se pasa, se reemplaza la voz mas vieja de ese efecto.
+// Los chunks ya estan en el formato del dispositivo (Mix_LoadWAV los convierte y el paquete los guarda
+// asi), el callback solo suma muestras de 16 bits con saturacion.
+
+
+const int MUESTRAS_BUFFER_AUDIO = 512; // ~11.6 ms a 44100 Hz
+const int CAPACIDAD_COMANDOS_AUDIO = 256; // Potencia de 2
+const int MAXIMO_VOCES = 16;
+
+// Demora desde el rebote hasta que suena: un bloque de audio mas un frame a 60 Hz, porque la fisica
+// de un frame se simula al principio del frame siguiente
+const double ADELANTO_EFECTOS = 0.030;
+
+// Dos golpes del mismo efecto mas juntos que esto suenan como uno
+const double SEPARACION_MINIMA_EFECTO = 0.015;
+
+
+enum efectoSonido { SONIDO_REBOTE, SONIDO_PUNTO, TOTAL_SONIDOS };
+
+
+struct limiteEfecto {
+    int voces; // Maximo sonando a la vez
+    float volumen;
+};
+
+const limiteEfecto LIMITES_EFECTOS[TOTAL_SONIDOS] = {
+    { 4, 0.7f }, // Rebote: en el modo caos hay muchos por segundo
+    { 2, 1.0f }, // Punto
+};
+
+
+struct comandoAudio {
+    uint8_t efecto;
+    int64_t muestra; // Muestra del dispositivo en la que empieza
+};
+
+
+struct vozAudio {
+    bool activa = false;
+    uint8_t efecto = 0;
+    int64_t inicio = 0; // Muestra del dispositivo en la que empieza
+    uint32_t posicion = 0; // Cuadros ya mezclados
+    uint64_t orden = 0; // Para saber cual es la mas vieja
+};
+
+
+struct motorAudio {
+    bool activo = false; // Si el formato no es S16 se usa Mix_PlayChannel como antes
+    int frecuencia = 0;
+    int canales = 0;
+    Mix_Chunk* chunks[TOTAL_SONIDOS] = {};
+
+    // Sonidos publicados para el hilo de audio; el largo se escribe antes que los datos
+    std::atomic<const Sint16*> datos[TOTAL_SONIDOS] = {};
+    uint32_t cuadros[TOTAL_SONIDOS] = {};
+
+    // Cola del juego al callback
+    comandoAudio comandos[CAPACIDAD_COMANDOS_AUDIO];
+    std::atomic<uint32_t> escritos{ 0 }, leidos{ 0 };
+
+    // Reloj del dispositivo: cuantos cuadros se mezclaron y el contador de alto rendimiento en ese momento.
+    // Lo escribe el callback con un contador de version (impar mientras escribe), nunca espera.
+    std::atomic<uint32_t> version{ 0 };
+    std::atomic<int64_t> relojMuestras{ 0 };
+    std::atomic<Uint64> relojContador{ 0 };
+
+    // Solo el hilo de audio
+    vozAudio voces[MAXIMO_VOCES];
+    int64_t mezcladas = 0;
+    uint64_t orden = 0;
+    int64_t ultimoInicio[TOTAL_SONIDOS] = {};
+
+    // Para el panel: comandos perdidos por cola llena, voces reemplazadas, golpes unidos y tardes
+    std::atomic<uint32_t> descartados{ 0 }, robadas{ 0 }, unidos{ 0 }, tarde{ 0 };
+};
+
+
+// Busca lugar para un sonido nuevo: respeta el limite del efecto y si no hay voces libres usa la mas vieja
+inline vozAudio* elegirVoz(motorAudio& motor, uint8_t efecto) {
+    vozAudio* libre = nullptr;
+    vozAudio* masViejaEfecto = nullptr;
+    vozAudio* masVieja = nullptr;
+    int delEfecto = 0;
+    for (vozAudio& voz : motor.voces) {
+        if (!voz.activa) {
+            if (!libre) libre = &voz;
+            continue;
+        }
+        if (!masVieja || voz.orden < masVieja->orden) masVieja = &voz;
+        if (voz.efecto != efecto) continue;
+        delEfecto++;
+        if (!masViejaEfecto || voz.orden < masViejaEfecto->orden) masViejaEfecto = &voz;
+    }
+    if (delEfecto >= LIMITES_EFECTOS[efecto].voces) {
+        motor.robadas++;
+        return masViejaEfecto;
+    }
+    if (libre) return libre;
+    motor.robadas++;
+    return masVieja;
+}
+
+
+inline void empezarVoz(motorAudio& motor, const comandoAudio& comando) {
+    int64_t separacion = (int64_t)(SEPARACION_MINIMA_EFECTO * motor.frecuencia);
+    int64_t anterior = motor.ultimoInicio[comando.efecto];
+    if (anterior && comando.muestra >= anterior && comando.muestra - anterior < separacion) {
+        motor.unidos++;
+        return;
+    }
+    vozAudio* voz = elegirVoz(motor, comando.efecto);
+    voz->activa = true;
+    voz->efecto = comando.efecto;
+    voz->inicio = comando.muestra;
+    voz->posicion = 0;
+    voz->orden = ++motor.orden;
+    motor.ultimoInicio[comando.efecto] = comando.muestra;
+}
+
+
+// Callback de post-mezcla: la musica de SDL_mixer ya esta en flujo, se le suman los efectos
+inline void mezclarEfectos(void* datos, Uint8* flujo, int bytes) {
+    motorAudio& motor = *(motorAudio*)datos;
+    Sint16* salida = (Sint16*)flujo;
+    int canales = motor.canales;
+    int cuadros = bytes / (int)(sizeof(Sint16) * canales);
+    int64_t inicioBloque = motor.mezcladas;
+
+    uint32_t escritos = motor.escritos.load(std::memory_order_acquire);
+    uint32_t leidos = motor.leidos.load(std::memory_order_relaxed);
+    for (; leidos != escritos; leidos++) {
+        const comandoAudio& comando = motor.comandos[leidos & (CAPACIDAD_COMANDOS_AUDIO - 1)];
+        if (!motor.datos[comando.efecto].load(std::memory_order_acquire)) continue;
+        if (comando.muestra < inicioBloque) motor.tarde++;
+        empezarVoz(motor, comando);
+    }
+    motor.leidos.store(leidos, std::memory_order_release);
+
+    for (vozAudio& voz : motor.voces) {
+        if (!voz.activa) continue;
+        const Sint16* muestras = motor.datos[voz.efecto].load(std::memory_order_acquire);
+        uint32_t total = motor.cuadros[voz.efecto];
+
+        // Empieza en su muestra exacta dentro del bloque; si llego tarde, al principio
+        int64_t desde = voz.inicio - inicioBloque;
+        if (desde >= cuadros) continue;
+        int primero = desde > 0 ? (int)desde : 0;
+        int volumen = (int)(LIMITES_EFECTOS[voz.efecto].volumen * 256);
+        for (int cuadro = primero; cuadro < cuadros && voz.posicion < total; cuadro++, voz.posicion++) {
+            for (int canal = 0; canal < canales; canal++) {
+                int valor = salida[cuadro * canales + canal] + ((muestras[voz.posicion * canales + canal] * volumen) >> 8);
+                salida[cuadro * canales + canal] = (Sint16)(valor > 32767 ? 32767 : valor < -32768 ? -32768 : valor);
+            }
+        }
+        if (voz.posicion >= total) voz.activa = false;
+    }
+
+    motor.mezcladas += cuadros;
+    motor.version.fetch_add(1, std::memory_order_acq_rel);
+    motor.relojMuestras.store(motor.mezcladas, std::memory_order_relaxed);
+    motor.relojContador.store(SDL_GetPerformanceCounter(), std::memory_order_relaxed);
+    motor.version.fetch_add(1, std::memory_order_release);
+}
+
+
+// Despues de Mix_OpenAudio. Si el dispositivo no quedo en 16 bits los efectos van por Mix_PlayChannel
+inline void iniciarAudio(motorAudio& motor) {
+    Uint16 formato;
+    if (!Mix_QuerySpec(&motor.frecuencia, &formato, &motor.canales)) return;
+    motor.activo = formato == AUDIO_S16SYS;
+    if (!motor.activo) {
+        fprintf(stderr, "El audio no quedo en 16 bits, los efectos se tocan sin programar\n");
+        return;
+    }
+    motor.relojContador = SDL_GetPerformanceCounter();
+    Mix_SetPostMix(mezclarEfectos, &motor);
+}
+
+
+// Los chunks llegan desde el cargador; desde aca el hilo de audio los puede usar
+inline void asignarSonido(motorAudio& motor, efectoSonido efecto, Mix_Chunk* chunk) {
+    if (!chunk || motor.chunks[efecto]) return;
+    motor.chunks[efecto] = chunk;
+    motor.cuadros[efecto] = chunk->alen / (uint32_t)(sizeof(Sint16) * (motor.canales ? motor.canales : 1));
+    if (motor.activo) motor.datos[efecto].store((const Sint16*)chunk->abuf, std::memory_order_release);
+}
+
+
+// Pasa un momento del contador de alto rendimiento (en segundos) a una muestra del dispositivo
+inline int64_t muestraDelMomento(const motorAudio& motor, double momento) {
+    int64_t muestras;
+    Uint64 contador;
+    uint32_t version;
+    do {
+        version = motor.version.load(std::memory_order_acquire);
+        muestras = motor.relojMuestras.load(std::memory_order_relaxed);
+        contador = motor.relojContador.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((version & 1) || version != motor.version.load(std::memory_order_acquire));
+    double desdeMezcla = momento - (double)contador / SDL_GetPerformanceFrequency();
+    return muestras + (int64_t)((desdeMezcla + ADELANTO_EFECTOS) * motor.frecuencia);
+}
+
+
+// Programa un efecto para que suene ADELANTO_EFECTOS despues de momento (segundos del contador)
+inline void tocarEfecto(motorAudio& motor, efectoSonido efecto, double momento) {
+    if (!motor.chunks[efecto]) return;
+    if (!motor.activo) {
+        Mix_PlayChannel(-1, motor.chunks[efecto], 0);
+        return;
+    }
+    uint32_t escritos = motor.escritos.load(std::memory_order_relaxed);
+    if (escritos - motor.leidos.load(std::memory_order_acquire) >= (uint32_t)CAPACIDAD_COMANDOS_AUDIO) {
+        motor.descartados++;
+        return;
+    }
+    motor.comandos[escritos & (CAPACIDAD_COMANDOS_AUDIO - 1)] = { (uint8_t)efecto, muestraDelMomento(motor, momento) };
+    motor.escritos.store(escritos + 1, std::memory_order_release);
+}
+
+
+// Antes de liberar los chunks: Mix_SetPostMix espera a que termine el callback en curso
+inline void cerrarAudio(motorAudio& motor) {
+    if (motor.activo) Mix_SetPostMix(NULL, NULL);
+    motor.activo = false;
+}
@@ -0,0 +1,388 @@
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "simulacion.h"
+#include "reglas.h"
+#include "lotes.h"
+#include "texto.h"
+
+// Programa aparte: mide la simulacion, el nucleo de colisiones y el dibujo con el renderizador
+// por software de SDL (sin ventana, sirve en maquinas sin pantalla) y escribe los resultados en JSON.
+// Uso: benchmark [--segundos S] [--fuente arial.ttf] [--salida resultados.json]
+//                [--base anterior.json] [--tolerancia 0.10]
+// Con --base compara contra una corrida anterior y termina con error si algo empeoro mas que la tolerancia.
+
+
+// Todos los valores son "cuanto mas, mejor", asi la comparacion es igual para todos
+struct resultadoBenchmark {
+    std::string nombre;
+    const char* unidad;
+    double valor; // unidades por segundo
+    long long iteraciones;
+    double segundos;
+};
+
+
+struct configuracionBenchmark {
+    double segundos = 1.0; // Tiempo minimo de cada medicion
+    const char* fuente = "assets/arial.ttf";
+    const char* salida = nullptr; // nullptr = salida estandar
+    const char* base = nullptr;
+    double tolerancia = 0.10;
+};
+
+
+// Llama a la funcion en tandas cada vez mas grandes hasta pasar el tiempo minimo, tres veces,
+// y se queda con la mejor (la menos molestada por otros procesos).
+// trabajoPorLlamada es cuantas unidades (pasos, pelotas, frames) hace cada llamada.
+const int REPETICIONES_BENCHMARK = 3;
+
+template <typename F>
+resultadoBenchmark medir(const char* nombre, const char* unidad, double segundosMinimos, long long trabajoPorLlamada, F llamada) {
+    typedef std::chrono::steady_clock reloj;
+    llamada(); // Calentar caches y memoria
+
+    resultadoBenchmark mejor = { nombre, unidad, 0, 0, 0 };
+    for (int repeticion = 0; repeticion < REPETICIONES_BENCHMARK; repeticion++) {
+        long long tanda = 1, llamadas = 0;
+        double transcurrido = 0;
+        reloj::time_point inicio = reloj::now();
+        while (transcurrido < segundosMinimos / REPETICIONES_BENCHMARK) {
+            for (long long i = 0; i < tanda; i++) llamada();
+            llamadas += tanda;
+            tanda *= 2;
+            transcurrido = std::chrono::duration<double>(reloj::now() - inicio).count();
+        }
+        double valor = llamadas * trabajoPorLlamada / transcurrido;
+        if (valor > mejor.valor) mejor = { nombre, unidad, valor, llamadas, transcurrido };
+    }
+    std::fprintf(stderr, "%-28s %14.0f %s\n", nombre, mejor.valor, unidad);
+    return mejor;
+}
+
+
+// Una partida contra si misma con las reglas R: la IA de los lotes, pero de a un estado.
+// POR_REGISTRO llama al paso por el puntero de REGISTRO_REGLAS, como el juego, en vez de la instancia directa
+template <class R, bool POR_REGISTRO = false>
+resultadoBenchmark medirPartida(const std::string& nombre, double segundos, modoReglas modo) {
+    estadoSimulacion estado;
+    inicializarSimulacionCon<R>(estado);
+    const float mitadPaleta = R::ALTURA_PALETA / 2.0f;
+    const juegoReglas& registro = REGISTRO_REGLAS[modo];
+
+    return medir(nombre.c_str(), "pasos/s", segundos, 120, [&]() {
+        for (int paso = 0; paso < 120; paso++) {
+            float objetivo = estado.pelota.y + R::TAMANIO_PELOTA / 2.0f;
+            uint8_t teclas = 0;
+            teclas |= objetivo < estado.paletaIzquierda.y + mitadPaleta - 4 ? IZQUIERDA_ARRIBA : 0;
+            teclas |= objetivo > estado.paletaIzquierda.y + mitadPaleta + 4 ? IZQUIERDA_ABAJO : 0;
+            teclas |= objetivo < estado.paletaDerecha.y + mitadPaleta - 4 ? DERECHA_ARRIBA : 0;
+            teclas |= objetivo > estado.paletaDerecha.y + mitadPaleta + 4 ? DERECHA_ABAJO : 0;
+            entradasPaso entradasDelPaso = entradasCompletas(teclas);
+            eventos ocurrido = POR_REGISTRO ? registro.avanzar(estado, entradasDelPaso, PASO_SIMULACION, nullptr)
+                : avanzarSimulacionCon<R>(estado, entradasDelPaso, PASO_SIMULACION);
+            if (ocurrido & EVENTO_FIN_PARTIDA) nuevaPartidaCon<R>(estado);
+        }
+    });
+}
+
+
+void medirSimulacion(const configuracionBenchmark& configuracion, std::vector<resultadoBenchmark>& resultados) {
+    // "simulacion" es la clasica; cada variante mide su propia instancia
+    paraCadaReglas([&](auto reglas, modoReglas modo) {
+        using R = decltype(reglas);
+        std::string nombre = modo == REGLAS_CLASICAS ? "simulacion" : std::string("simulacion_") + REGISTRO_REGLAS[modo].clave;
+        resultados.push_back(medirPartida<R>(nombre, configuracion.segundos, modo));
+    });
+    resultados.push_back(medirPartida<reglasClasicas, true>("simulacion_registro", configuracion.segundos, REGLAS_CLASICAS));
+
+    // El mismo paso para muchas partidas a la vez, en un solo hilo
+    configuracionLotes lotes;
+    loteDePartidas lote;
+    crearLote(lote, lotes.partidasPorHilo, lotes.semilla, lotes.parametros);
+    estadisticasLotes estadisticas;
+    long long pendientes = 1LL << 62;
+    resultados.push_back(medir("simulacion_lote", "pasos/s", configuracion.segundos, lote.cantidad, [&]() {
+        elegirEntradasLote(lote, lotes.modo, lotes.parametros);
+        avanzarLote(lote, lotes.parametros, PASO_SIMULACION);
+        anotarPuntosLote(lote, lotes.parametros, estadisticas, pendientes);
+    }));
+}
+
+
+// Pelotas repartidas por la cancha con velocidades al azar; se vuelven a poner cada segundo simulado
+struct escenaColisiones {
+    std::vector<float> x, y, vx, vy, impacto;
+    std::vector<float> inicioX, inicioY, inicioVX, inicioVY;
+    std::vector<uint8_t> golpes;
+    float izquierdaX = 20, izquierdaY = ALTURA_VENTANA / 2.0f, derechaX = ANCHO_VENTANA - 35, derechaY = ALTURA_VENTANA / 2.0f;
+    int pasos = 0;
+};
+
+
+void crearEscena(escenaColisiones& escena, int cantidad) {
+    uint32_t azar = 12345;
+    for (int i = 0; i < cantidad; i++) {
+        escena.inicioX.push_back(ANCHO_VENTANA / 2.0f + azarCentrado(azar) * (ANCHO_VENTANA / 2.0f - 40));
+        escena.inicioY.push_back(ALTURA_VENTANA / 2.0f + azarCentrado(azar) * (ALTURA_VENTANA / 2.0f - 10));
+        escena.inicioVX.push_back(azarCentrado(azar) * 2 * VELOCIDAD_PELOTA);
+        escena.inicioVY.push_back(azarCentrado(azar) * 2 * VELOCIDAD_PELOTA);
+    }
+    escena.x = escena.inicioX;
+    escena.y = escena.inicioY;
+    escena.vx = escena.inicioVX;
+    escena.vy = escena.inicioVY;
+    escena.impacto.assign(cantidad, 0);
+    escena.golpes.assign(cantidad, 0);
+}
+
+
+// Un paso de todas las pelotas con un solo conjunto de instrucciones
+template <typename S>
+void barrerEscena(escenaColisiones& escena) {
+    if (++escena.pasos % 120 == 0) {
+        escena.x = escena.inicioX;
+        escena.y = escena.inicioY;
+        escena.vx = escena.inicioVX;
+        escena.vy = escena.inicioVY;
+    }
+    pelotasColision pelotas = { escena.x.data(), escena.y.data(), escena.vx.data(), escena.vy.data(), escena.golpes.data(), escena.impacto.data(), (int)escena.x.size() };
+    paletasColision paletas = { &escena.izquierdaX, &escena.izquierdaY, &escena.derechaX, &escena.derechaY };
+    int i = 0;
+    for (; i + S::ANCHO <= pelotas.cantidad; i += S::ANCHO) barrerBloque<S, false>(pelotas, paletas, GEOMETRIA_CANCHA, PASO_SIMULACION, i);
+    for (; i < pelotas.cantidad; i++) barrerBloque<simdEscalar, false>(pelotas, paletas, GEOMETRIA_CANCHA, PASO_SIMULACION, i);
+}
+
+
+// Pelotas revisadas por segundo contra paredes y las dos paletas, con cada conjunto de instrucciones
+void medirColisiones(const configuracionBenchmark& configuracion, std::vector<resultadoBenchmark>& resultados) {
+    const int PELOTAS = 4096;
+    escenaColisiones escena;
+    crearEscena(escena, PELOTAS);
+    resultados.push_back(medir("colision_escalar", "pelotas/s", configuracion.segundos, PELOTAS, [&]() { barrerEscena<simdEscalar>(escena); }));
+#if COLISION_SSE2
+    resultados.push_back(medir("colision_sse2", "pelotas/s", configuracion.segundos, PELOTAS, [&]() { barrerEscena<simdSSE2>(escena); }));
+#endif
+#if COLISION_AVX2
+    resultados.push_back(medir("colision_avx2", "pelotas/s", configuracion.segundos, PELOTAS, [&]() { barrerEscena<simdAVX2>(escena); }));
+#endif
+}
+
+
+// Textura lisa del tamanio dado, para no depender de las imagenes del juego
+SDL_Texture* crearTexturaLisa(SDL_Renderer* renderizador, int ancho, int alto, Uint8 r, Uint8 g, Uint8 b) {
+    SDL_Surface* superficie = SDL_CreateRGBSurfaceWithFormat(0, ancho, alto, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!superficie) return nullptr;
+    SDL_FillRect(superficie, NULL, SDL_MapRGB(superficie->format, r, g, b));
+    SDL_Texture* textura = SDL_CreateTextureFromSurface(renderizador, superficie);
+    SDL_FreeSurface(superficie);
+    return textura;
+}
+
+
+// Texto y un frame de partida como los dibuja renderizarJuego, sobre una superficie en memoria
+bool medirDibujo(const configuracionBenchmark& configuracion, std::vector<resultadoBenchmark>& resultados) {
+    SDL_Surface* destino = SDL_CreateRGBSurfaceWithFormat(0, ANCHO_VENTANA, ALTURA_VENTANA, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderizador = destino ? SDL_CreateSoftwareRenderer(destino) : nullptr;
+    if (!renderizador) {
+        std::fprintf(stderr, "Error creando el renderizador por software: %s\n", SDL_GetError());
+        if (destino) SDL_FreeSurface(destino);
+        return false;
+    }
+
+    TTF_Font* fuente = TTF_OpenFont(configuracion.fuente, 24);
+    atlasTexto atlas;
+    if (!fuente || !crearAtlasTexto(renderizador, fuente, atlas)) {
+        std::fprintf(stderr, "Error cargando la fuente %s: %s\n", configuracion.fuente, TTF_GetError());
+        if (fuente) TTF_CloseFont(fuente);
+        SDL_DestroyRenderer(renderizador);
+        SDL_FreeSurface(destino);
+        return false;
+    }
+    TTF_CloseFont(fuente);
+
+    loteTexto lote;
+    inicializarLote(lote);
+    SDL_Color blanco = { 255, 255, 255, 255 };
+    const char* frase = "Jugador izquierdo: W/S/A/D - Jugador derecho: flechas";
+    const long long caracteres = (long long)strlen(frase);
+
+    // Solo armar los vertices
+    resultados.push_back(medir("texto_renderizarTexto", "caracteres/s", configuracion.segundos, caracteres, [&]() {
+        renderizarTexto(lote, atlas, frase, 20, 20, blanco);
+        lote.vertices.clear();
+        lote.indices.clear();
+    }));
+
+    // Armar y dibujar, con un menu completo por llamada
+    resultados.push_back(medir("texto_dibujar", "caracteres/s", configuracion.segundos, caracteres * 6, [&]() {
+        for (int linea = 0; linea < 6; linea++) renderizarTexto(lote, atlas, frase, 20, 100 + 40 * linea, blanco);
+        dibujarLoteTexto(renderizador, atlas, lote);
+    }));
+
+    // Frame de partida: fondo, dos sables, pelota y puntaje
+    SDL_Texture* fondo = crearTexturaLisa(renderizador, ANCHO_VENTANA, ALTURA_VENTANA, 10, 10, 40);
+    SDL_Texture* sable = crearTexturaLisa(renderizador, ANCHO_PALETA, ALTURA_PALETA, 255, 0, 0);
+    estadoSimulacion estado;
+    inicializarSimulacion(estado);
+    resultados.push_back(medir("frame_completo", "frames/s", configuracion.segundos, 1, [&]() {
+        avanzarSimulacion(estado, 0, PASO_SIMULACION);
+        if (estado.ganador != NINGUNO) nuevaPartida(estado);
+        SDL_RenderCopy(renderizador, fondo, NULL, NULL);
+        SDL_Rect izquierda = { (int)estado.paletaIzquierda.x, (int)estado.paletaIzquierda.y, ANCHO_PALETA, ALTURA_PALETA };
+        SDL_Rect derecha = { (int)estado.paletaDerecha.x, (int)estado.paletaDerecha.y, ANCHO_PALETA, ALTURA_PALETA };
+        SDL_RenderCopy(renderizador, sable, NULL, &izquierda);
+        SDL_RenderCopy(renderizador, sable, NULL, &derecha);
+        SDL_Rect bola = { (int)estado.pelota.x, (int)estado.pelota.y, TAMANIO_PELOTA, TAMANIO_PELOTA };
+        SDL_SetRenderDrawColor(renderizador, 255, 0, 0, 255);
+        SDL_RenderFillRect(renderizador, &bola);
+        char puntaje[32];
+        snprintf(puntaje, sizeof(puntaje), "%d - %d", estado.paletaIzquierda.puntaje, estado.paletaDerecha.puntaje);
+        renderizarTexto(lote, atlas, puntaje, ANCHO_VENTANA / 2 - 20, 20, blanco);
+        dibujarLoteTexto(renderizador, atlas, lote);
+        SDL_RenderPresent(renderizador);
+    }));
+
+    if (fondo) SDL_DestroyTexture(fondo);
+    if (sable) SDL_DestroyTexture(sable);
+    destruirAtlasTexto(atlas);
+    SDL_DestroyRenderer(renderizador);
+    SDL_FreeSurface(destino);
+    return true;
+}
+
+
+// Un resultado por linea, asi leerResultados no necesita un lector de JSON completo
+bool escribirResultados(const std::vector<resultadoBenchmark>& resultados, const char* ruta) {
+    FILE* archivo = ruta ? fopen(ruta, "w") : stdout;
+    if (!archivo) {
+        std::fprintf(stderr, "Error creando %s\n", ruta);
+        return false;
+    }
+#if COLISION_AVX2
+    const char* simd = "avx2";
+#elif COLISION_SSE2
+    const char* simd = "sse2";
+#else
+    const char* simd = "escalar";
+#endif
+    fprintf(archivo, "{\n  \"simd\": \"%s\",\n  \"resultados\": [\n", simd);
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const resultadoBenchmark& r = resultados[i];
+        fprintf(archivo, "    { \"nombre\": \"%s\", \"unidad\": \"%s\", \"valor\": %.1f, \"iteraciones\": %lld, \"segundos\": %.4f }%s\n",
+            r.nombre.c_str(), r.unidad, r.valor, r.iteraciones, r.segundos, i + 1 < resultados.size() ? "," : "");
+    }
+    fprintf(archivo, "  ]\n}\n");
+    bool correcto = !ferror(archivo);
+    if (ruta) fclose(archivo);
+    return correcto;
+}
+
+
+// Lee nombre y valor de cada linea que escribio escribirResultados
+bool leerResultados(const char* ruta, std::vector<resultadoBenchmark>& resultados) {
+    FILE* archivo = fopen(ruta, "r");
+    if (!archivo) {
+        std::fprintf(stderr, "Error abriendo %s\n", ruta);
+        return false;
+    }
+    char linea[512];
+    while (fgets(linea, sizeof(linea), archivo)) {
+        char nombre[128];
+        double valor;
+        const char* campoNombre = strstr(linea, "\"nombre\": \"");
+        const char* campoValor = strstr(linea, "\"valor\": ");
+        if (!campoNombre || !campoValor) continue;
+        if (sscanf(campoNombre, "\"nombre\": \"%127[^\"]\"", nombre) != 1 || sscanf(campoValor, "\"valor\": %lf", &valor) != 1) continue;
+        resultados.push_back({ nombre, "", valor, 0, 0 });
+    }
+    fclose(archivo);
+    return true;
+}
+
+
+// Cuenta los resultados que bajaron mas que la tolerancia respecto de la base
+int compararConBase(const std::vector<resultadoBenchmark>& resultados, const std::vector<resultadoBenchmark>& base, double tolerancia) {
+    int empeorados = 0;
+    for (const resultadoBenchmark& anterior : base) {
+        bool medido = false;
+        for (const resultadoBenchmark& actual : resultados) {
+            if (actual.nombre != anterior.nombre) continue;
+            medido = true;
+            if (anterior.valor <= 0) continue;
+            double cambio = actual.valor / anterior.valor - 1.0;
+            bool empeoro = cambio < -tolerancia;
+            std::fprintf(stderr, "%-28s %+7.1f%%%s\n", actual.nombre.c_str(), cambio * 100, empeoro ? "  EMPEORO" : "");
+            if (empeoro) empeorados++;
+        }
+
+        // Uno que se borro o se renombro no puede esconder un empeoramiento
+        if (!medido) {
+            std::fprintf(stderr, "%-28s    FALTA  (esta en la base y no se midio)\n", anterior.nombre.c_str());
+            empeorados++;
+        }
+    }
+    return empeorados;
+}
+
+
+bool leerConfiguracionBenchmark(int argc, char* argv[], configuracionBenchmark& configuracion) {
+    for (int i = 1; i < argc; i++) {
+        const char* opcion = argv[i];
+        const char* valor = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!valor) {
+            std::fprintf(stderr, "Falta el valor de %s\n", opcion);
+            return false;
+        }
+        if (!strcmp(opcion, "--segundos")) configuracion.segundos = atof(valor);
+        else if (!strcmp(opcion, "--fuente")) configuracion.fuente = valor;
+        else if (!strcmp(opcion, "--salida")) configuracion.salida = valor;
+        else if (!strcmp(opcion, "--base")) configuracion.base = valor;
+        else if (!strcmp(opcion, "--tolerancia")) configuracion.tolerancia = atof(valor);
+        else {
+            std::fprintf(stderr, "Opcion desconocida: %s\n", opcion);
+            return false;
+        }
+        i++;
+    }
+    return configuracion.segundos > 0 && configuracion.tolerancia >= 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    configuracionBenchmark configuracion;
+    if (!leerConfiguracionBenchmark(argc, argv, configuracion)) {
+        std::fprintf(stderr, "Uso: benchmark [--segundos S] [--fuente arial.ttf] [--salida resultados.json] [--base anterior.json] [--tolerancia 0.10]\n");
+        return 2;
+    }
+
+    std::vector<resultadoBenchmark> resultados;
+    medirSimulacion(configuracion, resultados);
+    medirColisiones(configuracion, resultados);
+
+    // El renderizador por software no necesita video; TTF si hace falta para el texto
+    bool dibujo = SDL_Init(0) == 0 && TTF_Init() == 0;
+    if (!dibujo) std::fprintf(stderr, "Error inicializando SDL: %s\n", SDL_GetError());
+    else dibujo = medirDibujo(configuracion, resultados);
+    TTF_Quit();
+    SDL_Quit();
+
+    if (!escribirResultados(resultados, configuracion.salida)) return 1;
+    if (!dibujo) return 1;
+
+    if (configuracion.base) {
+        std::vector<resultadoBenchmark> base;
+        if (!leerResultados(configuracion.base, base)) return 1;
+        int empeorados = compararConBase(resultados, base, configuracion.tolerancia);
+        if (empeorados > 0) {
+            std::fprintf(stderr, "%d resultados empeoraron mas de %.0f%% o faltan\n", empeorados, configuracion.tolerancia * 100);
+            return 1;
+        }
+    }
+    return 0;
+}
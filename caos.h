@@ -0,0 +1,199 @@
+#pragma once
+#include "simulacion.h"
+#include <string.h>
+#include <vector>
+
+// Modo caos: cada golpe de paleta divide la pelota y cada rebote suelta chispas.
+// Pelotas y chispas viven en arreglos separados por campo, reservados una sola vez al crear el modo.
+// Los lugares libres son siempre la cola: al morir una entidad se mueve la ultima a su lugar,
+// asi el nucleo de colisiones recorre solo lugares ocupados y contiguos.
+
+
+// Capacidad de los arreglos, no se pide memoria durante la partida
+const int MAXIMO_PELOTAS_CAOS = 4096;
+const int MAXIMO_CHISPAS = 16384;
+
+// Chispas que suelta cada rebote y cuanto duran (segundos)
+const int CHISPAS_POR_GOLPE = 6;
+const float VIDA_CHISPA = 0.35f;
+const float VELOCIDAD_CHISPA = 250.0f;
+
+// Con miles de pelotas los puntos llegan rapido
+const int PUNTAJE_GANADOR_CAOS = 100;
+
+
+struct poolPelotas {
+    int cantidad = 0;
+    std::vector<float> x, y, vx, vy;
+    std::vector<float> anteriorX, anteriorY; // Posicion del paso anterior, para interpolar al dibujar
+    std::vector<uint8_t> golpes; // Salida del nucleo de colisiones
+};
+
+
+struct poolChispas {
+    int cantidad = 0;
+    std::vector<float> x, y, vx, vy;
+    std::vector<float> vida; // Segundos que le quedan
+};
+
+
+struct estadoCaos {
+    poolPelotas pelotas;
+    poolChispas chispas;
+    uint32_t azar = 1;
+};
+
+
+// Reserva toda la memoria del modo, se llama una vez al iniciar el juego
+inline void crearCaos(estadoCaos& caos) {
+    poolPelotas& pelotas = caos.pelotas;
+    for (std::vector<float>* campo : { &pelotas.x, &pelotas.y, &pelotas.vx, &pelotas.vy, &pelotas.anteriorX, &pelotas.anteriorY }) {
+        campo->assign(MAXIMO_PELOTAS_CAOS, 0.0f);
+    }
+    pelotas.golpes.assign(MAXIMO_PELOTAS_CAOS, 0);
+
+    poolChispas& chispas = caos.chispas;
+    for (std::vector<float>* campo : { &chispas.x, &chispas.y, &chispas.vx, &chispas.vy, &chispas.vida }) {
+        campo->assign(MAXIMO_CHISPAS, 0.0f);
+    }
+}
+
+
+// Agrega una pelota si queda lugar, devuelve su indice o -1
+inline int agregarPelota(poolPelotas& pelotas, float x, float y, float vx, float vy) {
+    if (pelotas.cantidad >= MAXIMO_PELOTAS_CAOS) return -1;
+    int i = pelotas.cantidad++;
+    pelotas.x[i] = pelotas.anteriorX[i] = x;
+    pelotas.y[i] = pelotas.anteriorY[i] = y;
+    pelotas.vx[i] = vx;
+    pelotas.vy[i] = vy;
+    pelotas.golpes[i] = 0;
+    return i;
+}
+
+
+// Saca la pelota i poniendo la ultima en su lugar
+inline void quitarPelota(poolPelotas& pelotas, int i) {
+    int ultima = --pelotas.cantidad;
+    pelotas.x[i] = pelotas.x[ultima];
+    pelotas.y[i] = pelotas.y[ultima];
+    pelotas.vx[i] = pelotas.vx[ultima];
+    pelotas.vy[i] = pelotas.vy[ultima];
+    pelotas.anteriorX[i] = pelotas.anteriorX[ultima];
+    pelotas.anteriorY[i] = pelotas.anteriorY[ultima];
+    pelotas.golpes[i] = pelotas.golpes[ultima];
+}
+
+
+// Suelta chispas en todas direcciones; si no hay lugar se pierden, no pasa nada
+inline void soltarChispas(estadoCaos& caos, float x, float y) {
+    poolChispas& chispas = caos.chispas;
+    for (int k = 0; k < CHISPAS_POR_GOLPE && chispas.cantidad < MAXIMO_CHISPAS; k++) {
+        int i = chispas.cantidad++;
+        chispas.x[i] = x;
+        chispas.y[i] = y;
+        chispas.vx[i] = azarCentrado(caos.azar) * VELOCIDAD_CHISPA;
+        chispas.vy[i] = azarCentrado(caos.azar) * VELOCIDAD_CHISPA;
+        chispas.vida[i] = VIDA_CHISPA * (0.5f + 0.5f * (azarCentrado(caos.azar) * 0.5f + 0.5f));
+    }
+}
+
+
+// Mueve las chispas y quita las que se apagaron
+inline void avanzarChispas(poolChispas& chispas, float dt) {
+    int n = chispas.cantidad;
+    for (int i = 0; i < n; i++) {
+        chispas.x[i] += chispas.vx[i] * dt;
+        chispas.y[i] += chispas.vy[i] * dt;
+        chispas.vida[i] -= dt;
+    }
+    for (int i = 0; i < chispas.cantidad; ) {
+        if (chispas.vida[i] > 0) {
+            i++;
+            continue;
+        }
+        int ultima = --chispas.cantidad;
+        chispas.x[i] = chispas.x[ultima];
+        chispas.y[i] = chispas.y[ultima];
+        chispas.vx[i] = chispas.vx[ultima];
+        chispas.vy[i] = chispas.vy[ultima];
+        chispas.vida[i] = chispas.vida[ultima];
+    }
+}
+
+
+// Empieza una partida de caos con una sola pelota en el centro
+inline void nuevaPartidaCaos(estadoSimulacion& estado, estadoCaos& caos) {
+    nuevaPartida(estado);
+    caos.pelotas.cantidad = 0;
+    caos.chispas.cantidad = 0;
+    const pelota& bola = estado.pelota;
+    agregarPelota(caos.pelotas, bola.x, bola.y, bola.vx, bola.vy);
+}
+
+
+// Avanza un paso del modo caos: las paletas de estado y todas las pelotas del pool
+inline eventos avanzarCaos(estadoSimulacion& estado, estadoCaos& caos, const entradasPaso& teclas, float dt) {
+    eventos ocurrido = 0;
+    if (estado.ganador != NINGUNO) return ocurrido;
+
+    moverPaletas(estado, teclas, dt);
+
+    poolPelotas& pelotas = caos.pelotas;
+    memcpy(pelotas.anteriorX.data(), pelotas.x.data(), pelotas.cantidad * sizeof(float));
+    memcpy(pelotas.anteriorY.data(), pelotas.y.data(), pelotas.cantidad * sizeof(float));
+
+    // Todas las pelotas contra las mismas paletas, varias por instruccion
+    pelotasColision cuerpos = { pelotas.x.data(), pelotas.y.data(), pelotas.vx.data(), pelotas.vy.data(), pelotas.golpes.data(), nullptr, pelotas.cantidad };
+    paletasColision paletas = { &estado.paletaIzquierda.x, &estado.paletaIzquierda.y, &estado.paletaDerecha.x, &estado.paletaDerecha.y };
+    barrerPelotas(cuerpos, paletas, GEOMETRIA_CANCHA, dt);
+
+    avanzarChispas(caos.chispas, dt);
+
+    // Golpes y puntos; las pelotas nuevas van al final y no se revisan hasta el proximo paso
+    int revisar = pelotas.cantidad;
+    for (int i = 0; i < revisar; ) {
+        uint8_t golpes = pelotas.golpes[i];
+        if (golpes) {
+            ocurrido |= EVENTO_REBOTE;
+            soltarChispas(caos, pelotas.x[i] + TAMANIO_PELOTA / 2, pelotas.y[i] + TAMANIO_PELOTA / 2);
+        }
+
+        // Cada golpe de paleta divide la pelota, la copia sale con otro angulo
+        if (golpes & (GOLPE_PALETA_IZQUIERDA | GOLPE_PALETA_DERECHA)) {
+            float vy = -pelotas.vy[i] * (0.75f + 0.25f * (azarCentrado(caos.azar) + 1.0f));
+            agregarPelota(pelotas, pelotas.x[i], pelotas.y[i], pelotas.vx[i], vy);
+        }
+
+        int direccion = 0;
+        if (pelotas.x[i] + TAMANIO_PELOTA < 0) {
+            estado.paletaDerecha.puntaje++;
+            ocurrido |= EVENTO_PUNTO_DERECHA;
+            direccion = 1;
+        }
+        else if (pelotas.x[i] > ANCHO_VENTANA) {
+            estado.paletaIzquierda.puntaje++;
+            ocurrido |= EVENTO_PUNTO_IZQUIERDA;
+            direccion = -1;
+        }
+        if (!direccion) {
+            i++;
+            continue;
+        }
+
+        // La ultima pelota pasa al lugar i; si era de las nuevas se revisa igual el proximo paso
+        quitarPelota(pelotas, i);
+        if (pelotas.cantidad < revisar) revisar = pelotas.cantidad;
+        if (pelotas.cantidad == 0) {
+            reiniciarPelota(estado.pelota, direccion);
+            agregarPelota(pelotas, estado.pelota.x, estado.pelota.y, estado.pelota.vx, estado.pelota.vy);
+            break;
+        }
+    }
+
+    if (estado.paletaIzquierda.puntaje >= PUNTAJE_GANADOR_CAOS || estado.paletaDerecha.puntaje >= PUNTAJE_GANADOR_CAOS) {
+        estado.ganador = estado.paletaIzquierda.puntaje >= estado.paletaDerecha.puntaje ? GANA_IZQUIERDA : GANA_DERECHA;
+        ocurrido |= EVENTO_FIN_PARTIDA;
+    }
+    return ocurrido;
+}
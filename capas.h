@@ -0,0 +1,92 @@
+#pragma once
+#include <SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Capas cacheadas en texturas destino: lo que no cambia entre frames (fondo, textos del menu, puntaje)
+// se dibuja una vez en una textura y despues se copia con una sola llamada. Cada capa tiene una clave
+// hecha con todo lo que la afecta; si la clave cambia, se vuelve a dibujar.
+// Si el renderer no soporta texturas destino se dibuja todo directo, como antes.
+
+
+// Cuanto se duerme un frame sin cambios esperando eventos; tambien es cada cuanto se revisa la carga
+const int ESPERA_FRAME_QUIETO_MS = 100;
+
+
+struct capaCacheada {
+    SDL_Texture* textura = nullptr;
+    uint64_t clave = 0;
+    bool valida = false;
+};
+
+
+struct compositorCapas {
+    bool disponible = false; // El renderer soporta texturas destino
+    capaCacheada escena; // Pantallas quietas completas: menu, instrucciones, fin de partida
+    capaCacheada fondoPartida; // Fondo y puntaje durante la partida
+    uint64_t clavePresentada = 0; // Escena quieta que ya esta en pantalla
+    bool presentada = false;
+    SDL_Texture* destino = nullptr; // Donde va el frame: NULL es la ventana, otra textura al capturar
+};
+
+
+// Mezcla un valor en una clave (FNV-1a de 64 bits, por bytes)
+inline uint64_t mezclarClave(uint64_t clave, uint64_t valor) {
+    if (!clave) clave = 1469598103934665603ull;
+    for (int i = 0; i < 8; i++) {
+        clave ^= (valor >> (i * 8)) & 0xFF;
+        clave *= 1099511628211ull;
+    }
+    return clave;
+}
+
+
+inline void invalidarCapas(compositorCapas& compositor) {
+    compositor.escena.valida = false;
+    compositor.fondoPartida.valida = false;
+    compositor.presentada = false;
+}
+
+
+inline bool crearCapa(SDL_Renderer* renderizador, capaCacheada& capa, int ancho, int alto) {
+    capa.textura = SDL_CreateTexture(renderizador, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, ancho, alto);
+    capa.valida = false;
+    return capa.textura != nullptr;
+}
+
+
+// Sin soporte para texturas destino no es un error: el compositor queda apagado
+inline void crearCompositor(compositorCapas& compositor, SDL_Renderer* renderizador, int ancho, int alto) {
+    compositor.disponible = SDL_RenderTargetSupported(renderizador) &&
+        crearCapa(renderizador, compositor.escena, ancho, alto) &&
+        crearCapa(renderizador, compositor.fondoPartida, ancho, alto);
+    if (!compositor.disponible) fprintf(stderr, "Sin texturas destino, se dibuja todo en cada frame: %s\n", SDL_GetError());
+}
+
+
+inline void destruirCompositor(compositorCapas& compositor) {
+    if (compositor.escena.textura) SDL_DestroyTexture(compositor.escena.textura);
+    if (compositor.fondoPartida.textura) SDL_DestroyTexture(compositor.fondoPartida.textura);
+    compositor.escena.textura = compositor.fondoPartida.textura = nullptr;
+    compositor.disponible = false;
+}
+
+
+// Si la capa ya tiene esta clave devuelve false; si no, deja el renderer dibujando en ella
+inline bool empezarCapa(SDL_Renderer* renderizador, capaCacheada& capa, uint64_t clave) {
+    if (capa.valida && capa.clave == clave) return false;
+    SDL_SetRenderTarget(renderizador, capa.textura);
+    capa.clave = clave;
+    capa.valida = true;
+    return true;
+}
+
+
+inline void terminarCapa(SDL_Renderer* renderizador, const compositorCapas& compositor) {
+    SDL_SetRenderTarget(renderizador, compositor.destino);
+}
+
+
+inline void mostrarCapa(SDL_Renderer* renderizador, const capaCacheada& capa) {
+    SDL_RenderCopy(renderizador, capa.textura, NULL, NULL);
+}
@@ -0,0 +1,404 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Captura de frames a archivo sin pasar por la pantalla: el juego se dibuja en una textura destino, se
+// lee con SDL_RenderReadPixels a uno de varios buffers y un hilo aparte los convierte y los escribe.
+// Mientras el hilo escribe un frame el principal ya dibuja y lee el siguiente en otro buffer; si no queda
+// ninguno libre espera (no se pierden frames, la captura va tan rapido como el mas lento de los dos).
+// Formatos, segun la ruta:
+// - .y4m: un solo archivo YUV4MPEG2 4:2:0 (rango completo, BT.601), lo leen ffmpeg y la mayoria de editores.
+// - .png: una imagen por frame; la ruta lleva el numero como %d o %0Nd ("frames/%05d.png"), %% es un %.
+//   Van sin comprimir (bloques "stored" de deflate), para no depender de zlib.
+
+
+const int BUFFERS_CAPTURA = 3;
+const int FPS_CAPTURA_POR_DEFECTO = 60;
+const int DENOMINADOR_FPS_CAPTURA = 1000; // Precision de los FPS fraccionarios (29.97) en la cabecera Y4M
+
+
+enum formatoCaptura { CAPTURA_Y4M, CAPTURA_PNG };
+
+
+struct frameCaptura {
+    int buffer; // Indice en capturaFrames::buffers
+    long long numero;
+};
+
+
+struct capturaFrames {
+    formatoCaptura formato = CAPTURA_Y4M;
+    std::string ruta;
+    std::string prefijo, sufijo; // PNG: la ruta partida alrededor del numero de frame
+    int digitos = 0; // PNG: ancho del numero, con ceros adelante
+    int ancho = 0, alto = 0;
+    double fps = FPS_CAPTURA_POR_DEFECTO;
+    int fpsNumerador = FPS_CAPTURA_POR_DEFECTO, fpsDenominador = 1; // fps como fraccion reducida
+    SDL_Texture* destino = nullptr; // Donde se dibuja cada frame
+
+    // Compartido con el hilo que escribe
+    std::thread hilo;
+    std::mutex candado;
+    std::condition_variable aviso;
+    std::vector<std::vector<uint8_t>> buffers; // RGB24, ancho * alto * 3
+    std::vector<int> libres;
+    std::vector<frameCaptura> pendientes;
+    bool terminar = false;
+    long long escritos = 0;
+    long long descartados = 0; // No se pudieron leer o escribir
+
+    // Solo el hilo principal
+    FILE* archivo = nullptr; // Solo Y4M; lo usa el hilo mientras corre
+    long long capturados = 0;
+    long long esperas = 0; // Veces que no habia buffer libre y se espero al hilo
+    Uint64 inicio = 0;
+};
+
+
+struct resumenCaptura {
+    long long frames;
+    long long descartados;
+    long long esperas;
+    double segundos; // Tiempo real que llevo
+    double framesPorSegundo;
+    double vecesTiempoReal; // Segundos de video por segundo de captura
+};
+
+
+// PNG
+
+inline void agregarGrande32(std::vector<uint8_t>& datos, uint32_t valor) {
+    for (int i = 3; i >= 0; i--) datos.push_back((uint8_t)(valor >> (i * 8)));
+}
+
+
+inline uint32_t crc32Png(const uint8_t* datos, size_t largo, uint32_t crc = 0) {
+    static uint32_t tabla[256];
+    static bool lista = false;
+    if (!lista) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            tabla[i] = c;
+        }
+        lista = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < largo; i++) crc = tabla[(crc ^ datos[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+
+inline void agregarBloquePng(std::vector<uint8_t>& png, const char tipo[4], const uint8_t* datos, size_t largo) {
+    agregarGrande32(png, (uint32_t)largo);
+    size_t inicio = png.size();
+    png.insert(png.end(), tipo, tipo + 4);
+    png.insert(png.end(), datos, datos + largo);
+    agregarGrande32(png, crc32Png(png.data() + inicio, largo + 4));
+}
+
+
+// RGB24 a PNG de 8 bits por canal: cada fila con filtro 0 y todo en bloques deflate sin comprimir
+inline void codificarPng(const uint8_t* pixeles, int ancho, int alto, std::vector<uint8_t>& png, std::vector<uint8_t>& zlib) {
+    const uint8_t firma[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    png.assign(firma, firma + 8);
+
+    std::vector<uint8_t> cabecera;
+    agregarGrande32(cabecera, (uint32_t)ancho);
+    agregarGrande32(cabecera, (uint32_t)alto);
+    const uint8_t resto[5] = { 8, 2, 0, 0, 0 }; // 8 bits, RGB, deflate, filtros estandar, sin entrelazado
+    cabecera.insert(cabecera.end(), resto, resto + 5);
+    agregarBloquePng(png, "IHDR", cabecera.data(), cabecera.size());
+
+    size_t fila = (size_t)ancho * 3;
+    size_t crudo = (fila + 1) * alto;
+    zlib.resize(2 + crudo + (crudo / 65535 + 1) * 5);
+    zlib[0] = 0x78;
+    zlib[1] = 0x01;
+    uint8_t* escribir = zlib.data() + 2;
+    size_t quedan = crudo; // Bytes sin comprimir que faltan
+    size_t enBloque = 0; // Lugar que queda en el bloque abierto
+    uint32_t a = 1, b = 0; // Adler-32 de los datos sin comprimir
+
+    // Copia un pedazo de los datos sin comprimir abriendo bloques stored de hasta 65535 bytes
+    auto agregarCrudo = [&](const uint8_t* datos, size_t largo) {
+        while (largo > 0) {
+            if (enBloque == 0) {
+                uint16_t tamanio = (uint16_t)(quedan < 65535 ? quedan : 65535);
+                *escribir++ = quedan <= 65535 ? 1 : 0;
+                *escribir++ = (uint8_t)tamanio;
+                *escribir++ = (uint8_t)(tamanio >> 8);
+                *escribir++ = (uint8_t)~tamanio;
+                *escribir++ = (uint8_t)(~tamanio >> 8);
+                enBloque = tamanio;
+            }
+            // 5552 bytes es lo maximo que se puede sumar sin que b desborde antes del modulo
+            size_t parte = std::min(std::min(largo, enBloque), (size_t)5552);
+            memcpy(escribir, datos, parte);
+            for (size_t i = 0; i < parte; i++) {
+                a += datos[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            escribir += parte;
+            datos += parte;
+            largo -= parte;
+            enBloque -= parte;
+            quedan -= parte;
+        }
+    };
+    const uint8_t filtro = 0;
+    for (int y = 0; y < alto; y++) {
+        agregarCrudo(&filtro, 1);
+        agregarCrudo(pixeles + fila * y, fila);
+    }
+    zlib.resize(escribir - zlib.data());
+    agregarGrande32(zlib, (b << 16) | a);
+    agregarBloquePng(png, "IDAT", zlib.data(), zlib.size());
+    agregarBloquePng(png, "IEND", nullptr, 0);
+}
+
+
+// Y4M
+
+// RGB24 a planos Y, Cb y Cr 4:2:0 en rango completo (como JPEG); el color es el promedio de cada 2x2
+inline void convertirYuv420(const uint8_t* pixeles, int ancho, int alto, std::vector<uint8_t>& yuv) {
+    int anchoColor = (ancho + 1) / 2, altoColor = (alto + 1) / 2;
+    yuv.resize((size_t)ancho * alto + 2 * (size_t)anchoColor * altoColor);
+    uint8_t* planoY = yuv.data();
+    uint8_t* planoU = planoY + (size_t)ancho * alto;
+    uint8_t* planoV = planoU + (size_t)anchoColor * altoColor;
+    for (int y = 0; y < alto; y++) {
+        const uint8_t* p = pixeles + (size_t)y * ancho * 3;
+        for (int x = 0; x < ancho; x++, p += 3) {
+            planoY[(size_t)y * ancho + x] = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+    for (int cy = 0; cy < altoColor; cy++) {
+        for (int cx = 0; cx < anchoColor; cx++) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int dy = 0; dy < 2 && cy * 2 + dy < alto; dy++) {
+                for (int dx = 0; dx < 2 && cx * 2 + dx < ancho; dx++) {
+                    const uint8_t* p = pixeles + ((size_t)(cy * 2 + dy) * ancho + cx * 2 + dx) * 3;
+                    r += p[0]; g += p[1]; b += p[2]; n++;
+                }
+            }
+            r /= n; g /= n; b /= n;
+            planoU[(size_t)cy * anchoColor + cx] = (uint8_t)((-43 * r - 85 * g + 128 * b + 128 * 256 + 128) >> 8);
+            planoV[(size_t)cy * anchoColor + cx] = (uint8_t)((128 * r - 107 * g - 21 * b + 128 * 256 + 128) >> 8);
+        }
+    }
+}
+
+
+// Escribe un frame; corre en el hilo de la captura
+inline bool escribirFrameCaptura(capturaFrames& captura, const uint8_t* pixeles, long long numero, std::vector<uint8_t>& salida, std::vector<uint8_t>& auxiliar) {
+    if (captura.formato == CAPTURA_Y4M) {
+        convertirYuv420(pixeles, captura.ancho, captura.alto, salida);
+        fputs("FRAME\n", captura.archivo);
+        return fwrite(salida.data(), 1, salida.size(), captura.archivo) == salida.size();
+    }
+    char numeroFrame[32];
+    snprintf(numeroFrame, sizeof(numeroFrame), "%0*lld", captura.digitos, numero);
+    std::string ruta = captura.prefijo + numeroFrame + captura.sufijo;
+    codificarPng(pixeles, captura.ancho, captura.alto, salida, auxiliar);
+    FILE* archivo = fopen(ruta.c_str(), "wb");
+    if (!archivo) {
+        fprintf(stderr, "Error creando %s\n", ruta.c_str());
+        return false;
+    }
+    bool correcto = fwrite(salida.data(), 1, salida.size(), archivo) == salida.size();
+    correcto = fclose(archivo) == 0 && correcto;
+    if (!correcto) fprintf(stderr, "Error escribiendo %s\n", ruta.c_str());
+    return correcto;
+}
+
+
+inline void hiloCaptura(capturaFrames* captura) {
+    std::vector<uint8_t> salida, auxiliar; // Se reusan entre frames
+    std::vector<frameCaptura> lote;
+    while (true) {
+        bool terminar;
+        {
+            std::unique_lock<std::mutex> bloqueo(captura->candado);
+            captura->aviso.wait(bloqueo, [captura]() { return captura->terminar || !captura->pendientes.empty(); });
+            lote.swap(captura->pendientes);
+            terminar = captura->terminar;
+        }
+        for (const frameCaptura& frame : lote) {
+            bool correcto = escribirFrameCaptura(*captura, captura->buffers[frame.buffer].data(), frame.numero, salida, auxiliar);
+            std::lock_guard<std::mutex> bloqueo(captura->candado);
+            captura->libres.push_back(frame.buffer);
+            if (correcto) captura->escritos++;
+            else captura->descartados++;
+            captura->aviso.notify_all();
+        }
+        lote.clear();
+        if (terminar) break;
+    }
+}
+
+
+// Parte la ruta de los PNG en lo que va antes y despues del numero. Acepta un solo %d o %0Nd y %% para
+// un %; la ruta nunca se usa como formato de printf
+inline bool partirRutaPng(capturaFrames& captura, const char* ruta) {
+    captura.prefijo.clear();
+    captura.sufijo.clear();
+    bool numero = false;
+    for (const char* c = ruta; *c; c++) {
+        std::string& destino = numero ? captura.sufijo : captura.prefijo;
+        if (*c != '%') {
+            destino += *c;
+            continue;
+        }
+        if (c[1] == '%') {
+            destino += '%';
+            c++;
+            continue;
+        }
+        const char* fin = c + 1;
+        int digitos = 0;
+        if (*fin == '0') {
+            fin++;
+            while (*fin >= '0' && *fin <= '9' && digitos < 100) digitos = digitos * 10 + *fin++ - '0';
+            if (!digitos) return false;
+        }
+        if (numero || *fin != 'd' || digitos > 20) return false;
+        captura.digitos = digitos;
+        numero = true;
+        c = fin;
+    }
+    return numero;
+}
+
+
+// fps es el de los frames que salen, no cuanto tarda en capturarlos; puede ser fraccionario (29.97)
+inline bool iniciarCaptura(capturaFrames& captura, SDL_Renderer* renderizador, const char* ruta, int ancho, int alto, double fps) {
+    const char* punto = strrchr(ruta, '.');
+    if (punto && !strcmp(punto, ".png")) captura.formato = CAPTURA_PNG;
+    else if (punto && !strcmp(punto, ".y4m")) captura.formato = CAPTURA_Y4M;
+    else {
+        fprintf(stderr, "La captura tiene que ser .y4m o .png: %s\n", ruta);
+        return false;
+    }
+    if (captura.formato == CAPTURA_PNG && !partirRutaPng(captura, ruta)) {
+        fprintf(stderr, "La ruta de los PNG necesita un solo numero de frame (%%d o %%0Nd, %%%% para un %%), por ejemplo frames/%%05d.png\n");
+        return false;
+    }
+    captura.ruta = ruta;
+    captura.ancho = ancho;
+    captura.alto = alto;
+
+    // Los fps como fraccion reducida para la cabecera Y4M: 29.97 queda 2997:100
+    int numerador = fps > 0 && fps < 1000000 ? (int)(fps * DENOMINADOR_FPS_CAPTURA + 0.5) : 0;
+    int denominador = DENOMINADOR_FPS_CAPTURA;
+    if (numerador <= 0) {
+        numerador = FPS_CAPTURA_POR_DEFECTO;
+        denominador = 1;
+    }
+    int a = numerador, b = denominador;
+    while (b) {
+        int resto = a % b;
+        a = b;
+        b = resto;
+    }
+    captura.fpsNumerador = numerador / a;
+    captura.fpsDenominador = denominador / a;
+    captura.fps = (double)captura.fpsNumerador / captura.fpsDenominador;
+
+    if (!SDL_RenderTargetSupported(renderizador)) {
+        fprintf(stderr, "La captura necesita texturas destino: %s\n", SDL_GetError());
+        return false;
+    }
+    captura.destino = SDL_CreateTexture(renderizador, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, ancho, alto);
+    if (!captura.destino) {
+        fprintf(stderr, "Error creando la textura de la captura: %s\n", SDL_GetError());
+        return false;
+    }
+
+    if (captura.formato == CAPTURA_Y4M) {
+        captura.archivo = fopen(ruta, "wb");
+        if (!captura.archivo) {
+            fprintf(stderr, "Error creando %s\n", ruta);
+            SDL_DestroyTexture(captura.destino);
+            captura.destino = nullptr;
+            return false;
+        }
+        fprintf(captura.archivo, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", ancho, alto, captura.fpsNumerador, captura.fpsDenominador);
+    }
+
+    captura.buffers.assign(BUFFERS_CAPTURA, std::vector<uint8_t>((size_t)ancho * alto * 3));
+    captura.libres.clear();
+    for (int i = 0; i < BUFFERS_CAPTURA; i++) captura.libres.push_back(i);
+    captura.terminar = false;
+    captura.inicio = SDL_GetPerformanceCounter();
+    captura.hilo = std::thread(hiloCaptura, &captura);
+    return true;
+}
+
+
+// Despues de dibujar el frame en captura.destino: lo lee a un buffer libre y se lo pasa al hilo
+inline void capturarFrame(capturaFrames& captura, SDL_Renderer* renderizador) {
+    int buffer;
+    {
+        std::unique_lock<std::mutex> bloqueo(captura.candado);
+        if (captura.libres.empty()) {
+            captura.esperas++;
+            captura.aviso.wait(bloqueo, [&captura]() { return !captura.libres.empty(); });
+        }
+        buffer = captura.libres.back();
+        captura.libres.pop_back();
+    }
+
+    long long numero = captura.capturados++;
+    SDL_SetRenderTarget(renderizador, captura.destino);
+    bool leido = SDL_RenderReadPixels(renderizador, NULL, SDL_PIXELFORMAT_RGB24, captura.buffers[buffer].data(), captura.ancho * 3) == 0;
+    {
+        std::lock_guard<std::mutex> bloqueo(captura.candado);
+        if (leido) {
+            captura.pendientes.push_back({ buffer, numero });
+        }
+        else {
+            captura.libres.push_back(buffer);
+            captura.descartados++;
+        }
+    }
+    if (!leido) fprintf(stderr, "Error leyendo el frame %lld: %s\n", numero, SDL_GetError());
+    captura.aviso.notify_all();
+}
+
+
+// Espera a que se escriba todo, cierra y devuelve los contadores
+inline resumenCaptura terminarCaptura(capturaFrames& captura) {
+    if (captura.hilo.joinable()) {
+        {
+            std::lock_guard<std::mutex> bloqueo(captura.candado);
+            captura.terminar = true;
+        }
+        captura.aviso.notify_all();
+        captura.hilo.join();
+    }
+    if (captura.archivo) {
+        if (fclose(captura.archivo) != 0) {
+            fprintf(stderr, "Error escribiendo %s\n", captura.ruta.c_str());
+            captura.descartados += captura.escritos;
+            captura.escritos = 0;
+        }
+        captura.archivo = nullptr;
+    }
+    if (captura.destino) SDL_DestroyTexture(captura.destino);
+    captura.destino = nullptr;
+
+    double segundos = (double)(SDL_GetPerformanceCounter() - captura.inicio) / SDL_GetPerformanceFrequency();
+    double porSegundo = segundos > 0 ? captura.escritos / segundos : 0;
+    return { captura.escritos, captura.descartados, captura.esperas, segundos, porSegundo, porSegundo / captura.fps };
+}
@@ -0,0 +1,276 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "paquete.h"
+#include "texto.h"
+
+// Carga de recursos en segundo plano: unos hilos leen y decodifican imagenes, sonidos y la fuente
+// mientras el juego ya dibuja el menu. El hilo principal solo sube las texturas al renderizador
+// (lo unico que SDL no deja hacer desde otro hilo) a medida que cada trabajo termina.
+
+
+const int MAXIMO_TRABAJOS_CARGA = 16;
+
+
+enum tipoCarga { CARGA_FUENTE, CARGA_TEXTURA, CARGA_SONIDO, CARGA_MUSICA };
+enum estadoCarga { CARGA_PENDIENTE, CARGA_LISTA, CARGA_FALLIDA, CARGA_USADA };
+
+
+// Pixeles listos para subir; apuntan al paquete mapeado o a la superficie propia
+struct imagenDecodificada {
+    const void* pixeles = nullptr;
+    int ancho = 0, alto = 0, pitch = 0;
+    Uint32 formato = SDL_PIXELFORMAT_UNKNOWN;
+    SDL_Surface* superficie = nullptr; // Solo si vino de un BMP suelto
+};
+
+
+// Un recurso: que cargar, donde dejarlo y lo que produjo el hilo
+struct trabajoCarga {
+    const char* nombre = nullptr;
+    tipoCarga tipo = CARGA_TEXTURA;
+    int tamanioFuente = 0;
+
+    // Destino en el juego, lo escribe solo el hilo principal
+    SDL_Texture** destinoTextura = nullptr;
+    Mix_Chunk** destinoSonido = nullptr;
+    Mix_Music** destinoMusica = nullptr;
+    atlasTexto* destinoAtlas = nullptr;
+
+    // Resultado del hilo de carga, se lee despues de ver CARGA_LISTA
+    imagenDecodificada imagen;
+    atlasTexto atlas;
+    SDL_Surface* hojaAtlas = nullptr;
+    Mix_Chunk* sonido = nullptr;
+    Mix_Music* musica = nullptr;
+    std::string error;
+
+    std::atomic<int> estado{ CARGA_PENDIENTE };
+};
+
+
+struct cargadorRecursos {
+    trabajoCarga trabajos[MAXIMO_TRABAJOS_CARGA];
+    int cantidad = 0;
+    int terminados = 0; // Trabajos ya aplicados (o fallidos) por el hilo principal
+    std::atomic<int> siguiente{ 0 }; // Proximo trabajo libre para los hilos
+    std::vector<std::thread> hilos;
+    const paqueteRecursos* paquete = nullptr;
+};
+
+
+// Abre la fuente desde el paquete mapeado o desde assets/
+inline TTF_Font* cargarFuente(const paqueteRecursos& paquete, const char* nombre, int tamanio) {
+    const entradaPaquete* entrada = buscarRecurso(paquete, nombre, RECURSO_FUENTE);
+    if (entrada) return TTF_OpenFontRW(SDL_RWFromConstMem(datosRecurso(paquete, *entrada), (int)entrada->tamanio), 1, tamanio);
+    return TTF_OpenFont((std::string("assets/") + nombre).c_str(), tamanio);
+}
+
+
+// Efecto de sonido: si el mezclador abrio el mismo formato que el paquete se usa la memoria mapeada sin copiarla
+inline Mix_Chunk* cargarSonido(const paqueteRecursos& paquete, const char* nombre) {
+    const entradaPaquete* entrada = buscarRecurso(paquete, nombre, RECURSO_SONIDO);
+    if (!entrada) return Mix_LoadWAV((std::string("assets/") + nombre).c_str());
+
+    const uint8_t* datos = datosRecurso(paquete, *entrada);
+    int frecuencia = 0, canales = 0;
+    Uint16 formato = 0;
+    Mix_QuerySpec(&frecuencia, &formato, &canales);
+    if (frecuencia == entrada->frecuencia && formato == entrada->formato && canales == entrada->canales && entrada->tamanio > (uint64_t)CABECERA_WAV) {
+        // El mezclador solo lee las muestras, el mapeo es de solo lectura pero nadie escribe ahi
+        return Mix_QuickLoad_RAW((Uint8*)datos + CABECERA_WAV, (Uint32)(entrada->tamanio - CABECERA_WAV));
+    }
+    return Mix_LoadWAV_RW(SDL_RWFromConstMem(datos, (int)entrada->tamanio), 1);
+}
+
+
+// La musica se lee de a poco mientras suena, por eso el paquete queda mapeado hasta el final
+inline Mix_Music* cargarMusica(const paqueteRecursos& paquete, const char* nombre) {
+    const entradaPaquete* entrada = buscarRecurso(paquete, nombre, RECURSO_SONIDO);
+    if (entrada) return Mix_LoadMUS_RW(SDL_RWFromConstMem(datosRecurso(paquete, *entrada), (int)entrada->tamanio), 1);
+    return Mix_LoadMUS((std::string("assets/") + nombre).c_str());
+}
+
+
+// Imagen: del paquete se usan los pixeles mapeados tal cual, un BMP suelto se decodifica y convierte aca
+inline bool decodificarImagen(const paqueteRecursos& paquete, const char* nombre, imagenDecodificada& imagen) {
+    const entradaPaquete* entrada = buscarRecurso(paquete, nombre, RECURSO_TEXTURA);
+    if (entrada) {
+        imagen.pixeles = datosRecurso(paquete, *entrada);
+        imagen.ancho = entrada->ancho;
+        imagen.alto = entrada->alto;
+        imagen.pitch = entrada->pitch;
+        imagen.formato = entrada->formato;
+        return true;
+    }
+
+    SDL_Surface* original = SDL_LoadBMP((std::string("assets/") + nombre).c_str());
+    if (!original) return false;
+    imagen.superficie = SDL_ConvertSurfaceFormat(original, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(original);
+    if (!imagen.superficie) return false;
+    imagen.pixeles = imagen.superficie->pixels;
+    imagen.ancho = imagen.superficie->w;
+    imagen.alto = imagen.superficie->h;
+    imagen.pitch = imagen.superficie->pitch;
+    imagen.formato = SDL_PIXELFORMAT_ARGB8888;
+    return true;
+}
+
+
+// Sube los pixeles a una textura nueva (solo desde el hilo del renderizador)
+inline SDL_Texture* subirTextura(SDL_Renderer* renderizador, imagenDecodificada& imagen) {
+    SDL_Texture* textura = SDL_CreateTexture(renderizador, imagen.formato, SDL_TEXTUREACCESS_STATIC, imagen.ancho, imagen.alto);
+    if (textura) SDL_UpdateTexture(textura, NULL, imagen.pixeles, imagen.pitch);
+    if (imagen.superficie) SDL_FreeSurface(imagen.superficie);
+    imagen = imagenDecodificada();
+    return textura;
+}
+
+
+// Lo que hace un hilo con un trabajo; todo lo que toca es del trabajo o de solo lectura
+inline void ejecutarTrabajo(trabajoCarga& trabajo, const paqueteRecursos& paquete) {
+    bool correcto = false;
+    if (trabajo.tipo == CARGA_FUENTE) {
+        TTF_Font* fuente = cargarFuente(paquete, trabajo.nombre, trabajo.tamanioFuente);
+        correcto = fuente && rasterizarAtlas(fuente, trabajo.atlas, trabajo.hojaAtlas);
+        if (fuente) TTF_CloseFont(fuente);
+    }
+    else if (trabajo.tipo == CARGA_TEXTURA) {
+        correcto = decodificarImagen(paquete, trabajo.nombre, trabajo.imagen);
+    }
+    else if (trabajo.tipo == CARGA_SONIDO) {
+        trabajo.sonido = cargarSonido(paquete, trabajo.nombre);
+        correcto = trabajo.sonido != nullptr;
+    }
+    else {
+        trabajo.musica = cargarMusica(paquete, trabajo.nombre);
+        correcto = trabajo.musica != nullptr;
+    }
+
+    // El error de SDL es de cada hilo, se copia antes de avisar
+    if (!correcto) trabajo.error = SDL_GetError();
+    trabajo.estado.store(correcto ? CARGA_LISTA : CARGA_FALLIDA, std::memory_order_release);
+}
+
+
+// Cada hilo toma el siguiente trabajo libre hasta que no quede ninguno
+inline void hiloDeCarga(cargadorRecursos* cargador) {
+    for (;;) {
+        int i = cargador->siguiente.fetch_add(1);
+        if (i >= cargador->cantidad) return;
+        ejecutarTrabajo(cargador->trabajos[i], *cargador->paquete);
+    }
+}
+
+
+inline trabajoCarga& agregarTrabajo(cargadorRecursos& cargador, tipoCarga tipo, const char* nombre) {
+    trabajoCarga& trabajo = cargador.trabajos[cargador.cantidad++];
+    trabajo.tipo = tipo;
+    trabajo.nombre = nombre;
+    return trabajo;
+}
+
+
+inline void agregarFuente(cargadorRecursos& cargador, const char* nombre, int tamanio, atlasTexto* destino) {
+    trabajoCarga& trabajo = agregarTrabajo(cargador, CARGA_FUENTE, nombre);
+    trabajo.tamanioFuente = tamanio;
+    trabajo.destinoAtlas = destino;
+}
+
+
+inline void agregarTextura(cargadorRecursos& cargador, const char* nombre, SDL_Texture** destino) {
+    agregarTrabajo(cargador, CARGA_TEXTURA, nombre).destinoTextura = destino;
+}
+
+
+inline void agregarSonido(cargadorRecursos& cargador, const char* nombre, Mix_Chunk** destino) {
+    agregarTrabajo(cargador, CARGA_SONIDO, nombre).destinoSonido = destino;
+}
+
+
+inline void agregarMusica(cargadorRecursos& cargador, const char* nombre, Mix_Music** destino) {
+    agregarTrabajo(cargador, CARGA_MUSICA, nombre).destinoMusica = destino;
+}
+
+
+// Arranca los hilos; los trabajos se toman en el orden en que se agregaron
+inline void iniciarCarga(cargadorRecursos& cargador, const paqueteRecursos& paquete) {
+    cargador.paquete = &paquete;
+    int hilos = (int)std::thread::hardware_concurrency();
+    if (hilos < 1) hilos = 1;
+    if (hilos > cargador.cantidad) hilos = cargador.cantidad;
+    for (int i = 0; i < hilos; i++) cargador.hilos.emplace_back(hiloDeCarga, &cargador);
+}
+
+
+// Pone en el juego lo que ya termino; se llama una vez por frame desde el hilo principal.
+// Devuelve false si algun recurso no se pudo cargar.
+inline bool procesarCargas(cargadorRecursos& cargador, SDL_Renderer* renderizador) {
+    bool correcto = true;
+    for (int i = 0; i < cargador.cantidad; i++) {
+        trabajoCarga& trabajo = cargador.trabajos[i];
+        int estado = trabajo.estado.load(std::memory_order_acquire);
+        if (estado == CARGA_PENDIENTE || estado == CARGA_USADA) continue;
+        trabajo.estado.store(CARGA_USADA, std::memory_order_relaxed);
+        cargador.terminados++;
+
+        if (estado == CARGA_FALLIDA) {
+            std::cerr << "Error cargando " << trabajo.nombre << ": " << trabajo.error << std::endl;
+            correcto = false;
+            continue;
+        }
+
+        if (trabajo.tipo == CARGA_FUENTE) {
+            *trabajo.destinoAtlas = trabajo.atlas;
+            correcto = subirAtlas(renderizador, *trabajo.destinoAtlas, trabajo.hojaAtlas) && correcto;
+            trabajo.hojaAtlas = nullptr;
+        }
+        else if (trabajo.tipo == CARGA_TEXTURA) {
+            *trabajo.destinoTextura = subirTextura(renderizador, trabajo.imagen);
+            if (!*trabajo.destinoTextura) {
+                std::cerr << "Error creando textura de " << trabajo.nombre << ": " << SDL_GetError() << std::endl;
+                correcto = false;
+            }
+        }
+        else if (trabajo.tipo == CARGA_SONIDO) {
+            *trabajo.destinoSonido = trabajo.sonido;
+            trabajo.sonido = nullptr;
+        }
+        else {
+            *trabajo.destinoMusica = trabajo.musica;
+            trabajo.musica = nullptr;
+        }
+    }
+    return correcto;
+}
+
+
+inline bool cargaTerminada(const cargadorRecursos& cargador) {
+    return cargador.terminados == cargador.cantidad;
+}
+
+
+// Espera a los hilos y libera lo que se cargo pero nunca se uso (por ejemplo si se cerro el juego antes)
+inline void terminarCarga(cargadorRecursos& cargador) {
+    cargador.siguiente.store(cargador.cantidad);
+    for (std::thread& hilo : cargador.hilos) hilo.join();
+    cargador.hilos.clear();
+    for (int i = 0; i < cargador.cantidad; i++) {
+        trabajoCarga& trabajo = cargador.trabajos[i];
+        if (trabajo.estado.load() == CARGA_USADA) continue;
+        if (trabajo.hojaAtlas) SDL_FreeSurface(trabajo.hojaAtlas);
+        if (trabajo.imagen.superficie) SDL_FreeSurface(trabajo.imagen.superficie);
+        if (trabajo.sonido) Mix_FreeChunk(trabajo.sonido);
+        if (trabajo.musica) Mix_FreeMusic(trabajo.musica);
+        trabajo.hojaAtlas = nullptr;
+        trabajo.imagen = imagenDecodificada();
+        trabajo.sonido = nullptr;
+        trabajo.musica = nullptr;
+    }
+}
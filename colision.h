@@ -0,0 +1,363 @@
+#pragma once
+#include <stdint.h>
+#include <float.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COLISION_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLISION_SSE2 1
+#endif
+
+// Colision continua (AABB barrido) de muchas pelotas contra las dos paletas y las paredes.
+// Cada pelota recorre su desplazamiento del paso y rebota en el primer contacto, asi no atraviesa
+// una paleta aunque vaya muy rapido. Se procesan 8 (AVX2) o 4 (SSE2) pelotas por instruccion.
+// Con CUATRO_PALETAS hay ademas un par de paletas delanteras, en medio de la cancha: la pelota les
+// puede pegar de los dos lados, asi que rebota hacia el lado del que vino.
+
+
+// Rebotes que se resuelven como maximo en un paso (pared y paleta en la misma esquina, etc.)
+const int MAXIMO_REBOTES_POR_PASO = 4;
+
+
+// Lo que toco cada pelota durante el paso
+enum golpeColision : uint8_t {
+    GOLPE_PARED = 1 << 0,
+    GOLPE_PALETA_IZQUIERDA = 1 << 1,
+    GOLPE_PALETA_DERECHA = 1 << 2
+};
+
+
+// Medidas de la cancha, se pasan aparte para que el nucleo no dependa de las constantes del juego
+struct geometriaColision {
+    float techo; // y minima de la esquina de la pelota
+    float piso; // y maxima de la esquina de la pelota
+    float tamanioPelota;
+    float anchoPaleta;
+    float alturaPaleta;
+};
+
+
+// Pelotas en estructura de arreglos, se modifican en el lugar
+struct pelotasColision {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    uint8_t* golpes; // Salida: combinacion de golpeColision
+    float* impacto; // Salida opcional: segundos desde el inicio del paso hasta el primer golpe, -1 si no hubo
+    int cantidad;
+};
+
+
+// Posicion de las paletas: un valor compartido por todas las pelotas o uno por pelota
+struct paletasColision {
+    const float* izquierdaX;
+    const float* izquierdaY;
+    const float* derechaX;
+    const float* derechaY;
+};
+
+
+// Operaciones para una sola pelota, sirve de referencia y para las que sobran al final
+struct simdEscalar {
+    typedef float flotantes;
+    typedef bool mascara;
+    static const int ANCHO = 1;
+    static flotantes cargar(const float* p) { return *p; }
+    static void guardar(float* p, flotantes a) { *p = a; }
+    static flotantes repetir(float a) { return a; }
+    static flotantes sumar(flotantes a, flotantes b) { return a + b; }
+    static flotantes restar(flotantes a, flotantes b) { return a - b; }
+    static flotantes multiplicar(flotantes a, flotantes b) { return a * b; }
+    static flotantes dividir(flotantes a, flotantes b) { return a / b; }
+    static flotantes minimo(flotantes a, flotantes b) { return a < b ? a : b; }
+    static flotantes maximo(flotantes a, flotantes b) { return a > b ? a : b; }
+    static flotantes absoluto(flotantes a) { return a < 0 ? -a : a; }
+    static flotantes negar(flotantes a) { return -a; }
+    static mascara menor(flotantes a, flotantes b) { return a < b; }
+    static mascara menorIgual(flotantes a, flotantes b) { return a <= b; }
+    static mascara igual(flotantes a, flotantes b) { return a == b; }
+    static mascara y(mascara a, mascara b) { return a && b; }
+    static mascara o(mascara a, mascara b) { return a || b; }
+    static mascara yNo(mascara a, mascara b) { return !a && b; }
+    static mascara ninguna() { return false; }
+    static flotantes elegir(mascara m, flotantes si, flotantes no) { return m ? si : no; }
+    static int bits(mascara m) { return m ? 1 : 0; }
+};
+
+
+#if COLISION_SSE2
+struct simdSSE2 {
+    typedef __m128 flotantes;
+    typedef __m128 mascara;
+    static const int ANCHO = 4;
+    static flotantes cargar(const float* p) { return _mm_loadu_ps(p); }
+    static void guardar(float* p, flotantes a) { _mm_storeu_ps(p, a); }
+    static flotantes repetir(float a) { return _mm_set1_ps(a); }
+    static flotantes sumar(flotantes a, flotantes b) { return _mm_add_ps(a, b); }
+    static flotantes restar(flotantes a, flotantes b) { return _mm_sub_ps(a, b); }
+    static flotantes multiplicar(flotantes a, flotantes b) { return _mm_mul_ps(a, b); }
+    static flotantes dividir(flotantes a, flotantes b) { return _mm_div_ps(a, b); }
+    static flotantes minimo(flotantes a, flotantes b) { return _mm_min_ps(a, b); }
+    static flotantes maximo(flotantes a, flotantes b) { return _mm_max_ps(a, b); }
+    static flotantes absoluto(flotantes a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static flotantes negar(flotantes a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+    static mascara menor(flotantes a, flotantes b) { return _mm_cmplt_ps(a, b); }
+    static mascara menorIgual(flotantes a, flotantes b) { return _mm_cmple_ps(a, b); }
+    static mascara igual(flotantes a, flotantes b) { return _mm_cmpeq_ps(a, b); }
+    static mascara y(mascara a, mascara b) { return _mm_and_ps(a, b); }
+    static mascara o(mascara a, mascara b) { return _mm_or_ps(a, b); }
+    static mascara yNo(mascara a, mascara b) { return _mm_andnot_ps(a, b); }
+    static mascara ninguna() { return _mm_setzero_ps(); }
+    static flotantes elegir(mascara m, flotantes si, flotantes no) { return _mm_or_ps(_mm_and_ps(m, si), _mm_andnot_ps(m, no)); }
+    static int bits(mascara m) { return _mm_movemask_ps(m); }
+};
+#endif
+
+
+#if COLISION_AVX2
+struct simdAVX2 {
+    typedef __m256 flotantes;
+    typedef __m256 mascara;
+    static const int ANCHO = 8;
+    static flotantes cargar(const float* p) { return _mm256_loadu_ps(p); }
+    static void guardar(float* p, flotantes a) { _mm256_storeu_ps(p, a); }
+    static flotantes repetir(float a) { return _mm256_set1_ps(a); }
+    static flotantes sumar(flotantes a, flotantes b) { return _mm256_add_ps(a, b); }
+    static flotantes restar(flotantes a, flotantes b) { return _mm256_sub_ps(a, b); }
+    static flotantes multiplicar(flotantes a, flotantes b) { return _mm256_mul_ps(a, b); }
+    static flotantes dividir(flotantes a, flotantes b) { return _mm256_div_ps(a, b); }
+    static flotantes minimo(flotantes a, flotantes b) { return _mm256_min_ps(a, b); }
+    static flotantes maximo(flotantes a, flotantes b) { return _mm256_max_ps(a, b); }
+    static flotantes absoluto(flotantes a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static flotantes negar(flotantes a) { return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a); }
+    static mascara menor(flotantes a, flotantes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static mascara menorIgual(flotantes a, flotantes b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static mascara igual(flotantes a, flotantes b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static mascara y(mascara a, mascara b) { return _mm256_and_ps(a, b); }
+    static mascara o(mascara a, mascara b) { return _mm256_or_ps(a, b); }
+    static mascara yNo(mascara a, mascara b) { return _mm256_andnot_ps(a, b); }
+    static mascara ninguna() { return _mm256_setzero_ps(); }
+    static flotantes elegir(mascara m, flotantes si, flotantes no) { return _mm256_blendv_ps(no, si, m); }
+    static int bits(mascara m) { return _mm256_movemask_ps(m); }
+};
+#endif
+
+
+// Cuando entra y sale la pelota de la caja de una paleta (metodo de las franjas sobre la caja agrandada)
+template <typename S>
+inline void cruzarPaleta(typename S::flotantes x, typename S::flotantes y, typename S::flotantes inversaX, typename S::flotantes inversaY,
+    typename S::flotantes x0, typename S::flotantes y0, typename S::flotantes x1, typename S::flotantes y1,
+    typename S::flotantes& entrada, typename S::flotantes& salida, typename S::mascara& porLado) {
+    typename S::flotantes tx0 = S::multiplicar(S::restar(x0, x), inversaX);
+    typename S::flotantes tx1 = S::multiplicar(S::restar(x1, x), inversaX);
+    typename S::flotantes ty0 = S::multiplicar(S::restar(y0, y), inversaY);
+    typename S::flotantes ty1 = S::multiplicar(S::restar(y1, y), inversaY);
+    typename S::flotantes entradaX = S::minimo(tx0, tx1);
+    typename S::flotantes entradaY = S::minimo(ty0, ty1);
+    entrada = S::maximo(entradaX, entradaY);
+    salida = S::minimo(S::maximo(tx0, tx1), S::maximo(ty0, ty1));
+    porLado = S::menorIgual(entradaY, entradaX); // Toca la cara vertical de la paleta, no la de arriba o abajo
+}
+
+
+// Inversa del desplazamiento; una velocidad de 0 se toma como casi 0 para no dividir por cero
+template <typename S>
+inline typename S::flotantes inversaSegura(typename S::flotantes v) {
+    typename S::flotantes casiCero = S::repetir(1e-20f);
+    typename S::mascara cero = S::menor(S::absoluto(v), casiCero);
+    return S::dividir(S::repetir(1.0f), S::elegir(cero, casiCero, v));
+}
+
+
+// Resuelve el paso de S::ANCHO pelotas a partir de la posicion i; delanteras solo con CUATRO_PALETAS
+template <typename S, bool PALETA_POR_PELOTA, bool CUATRO_PALETAS = false>
+inline void barrerBloque(pelotasColision& pelotas, const paletasColision& paletas, const geometriaColision& geometria, float dt, int i,
+    const paletasColision* delanteras = nullptr) {
+    typedef typename S::flotantes F;
+    typedef typename S::mascara M;
+    const int p = PALETA_POR_PELOTA ? i : 0;
+    const F infinito = S::repetir(FLT_MAX);
+    const F cero = S::repetir(0.0f);
+    const F tamanio = S::repetir(geometria.tamanioPelota);
+    const F techo = S::repetir(geometria.techo);
+    const F piso = S::repetir(geometria.piso);
+
+    // Cajas de las paletas agrandadas por el tamao de la pelota: se prueba solo la esquina de la pelota
+    F izquierdaX = PALETA_POR_PELOTA ? S::cargar(paletas.izquierdaX + p) : S::repetir(paletas.izquierdaX[0]);
+    F izquierdaY = PALETA_POR_PELOTA ? S::cargar(paletas.izquierdaY + p) : S::repetir(paletas.izquierdaY[0]);
+    F derechaX = PALETA_POR_PELOTA ? S::cargar(paletas.derechaX + p) : S::repetir(paletas.derechaX[0]);
+    F derechaY = PALETA_POR_PELOTA ? S::cargar(paletas.derechaY + p) : S::repetir(paletas.derechaY[0]);
+    F anchoPaleta = S::repetir(geometria.anchoPaleta);
+    F alturaPaleta = S::repetir(geometria.alturaPaleta);
+    F izquierdaX0 = S::restar(izquierdaX, tamanio), izquierdaX1 = S::sumar(izquierdaX, anchoPaleta);
+    F izquierdaY0 = S::restar(izquierdaY, tamanio), izquierdaY1 = S::sumar(izquierdaY, alturaPaleta);
+    F derechaX0 = S::restar(derechaX, tamanio), derechaX1 = S::sumar(derechaX, anchoPaleta);
+    F derechaY0 = S::restar(derechaY, tamanio), derechaY1 = S::sumar(derechaY, alturaPaleta);
+    F delanteraIzquierdaX0, delanteraIzquierdaX1, delanteraIzquierdaY0, delanteraIzquierdaY1;
+    F delanteraDerechaX0, delanteraDerechaX1, delanteraDerechaY0, delanteraDerechaY1;
+    if constexpr (CUATRO_PALETAS) {
+        F ix = PALETA_POR_PELOTA ? S::cargar(delanteras->izquierdaX + p) : S::repetir(delanteras->izquierdaX[0]);
+        F iy = PALETA_POR_PELOTA ? S::cargar(delanteras->izquierdaY + p) : S::repetir(delanteras->izquierdaY[0]);
+        F dx = PALETA_POR_PELOTA ? S::cargar(delanteras->derechaX + p) : S::repetir(delanteras->derechaX[0]);
+        F dy = PALETA_POR_PELOTA ? S::cargar(delanteras->derechaY + p) : S::repetir(delanteras->derechaY[0]);
+        delanteraIzquierdaX0 = S::restar(ix, tamanio), delanteraIzquierdaX1 = S::sumar(ix, anchoPaleta);
+        delanteraIzquierdaY0 = S::restar(iy, tamanio), delanteraIzquierdaY1 = S::sumar(iy, alturaPaleta);
+        delanteraDerechaX0 = S::restar(dx, tamanio), delanteraDerechaX1 = S::sumar(dx, anchoPaleta);
+        delanteraDerechaY0 = S::restar(dy, tamanio), delanteraDerechaY1 = S::sumar(dy, alturaPaleta);
+    }
+
+    F x = S::cargar(pelotas.x + i);
+    F y = S::cargar(pelotas.y + i);
+    F vx = S::cargar(pelotas.vx + i);
+    F vy = S::cargar(pelotas.vy + i);
+    F restante = S::repetir(dt);
+    F impacto = S::repetir(-1.0f);
+    M golpesPared = S::ninguna(), golpesIzquierda = S::ninguna(), golpesDerecha = S::ninguna();
+
+    for (int rebote = 0; rebote < MAXIMO_REBOTES_POR_PASO; rebote++) {
+        F inversaX = inversaSegura<S>(vx);
+        F inversaY = inversaSegura<S>(vy);
+
+        // Techo y piso: solo si la pelota va hacia ellos
+        F tiempoTecho = S::elegir(S::menor(vy, cero), S::maximo(S::multiplicar(S::restar(techo, y), inversaY), cero), infinito);
+        F tiempoPiso = S::elegir(S::menor(cero, vy), S::maximo(S::multiplicar(S::restar(piso, y), inversaY), cero), infinito);
+        F tiempoPared = S::minimo(tiempoTecho, tiempoPiso);
+
+        // Paletas: hay choque si la entrada es antes de la salida y la salida todavia no paso
+        F entradaIzquierda, salidaIzquierda, entradaDerecha, salidaDerecha;
+        M ladoIzquierda, ladoDerecha;
+        cruzarPaleta<S>(x, y, inversaX, inversaY, izquierdaX0, izquierdaY0, izquierdaX1, izquierdaY1, entradaIzquierda, salidaIzquierda, ladoIzquierda);
+        cruzarPaleta<S>(x, y, inversaX, inversaY, derechaX0, derechaY0, derechaX1, derechaY1, entradaDerecha, salidaDerecha, ladoDerecha);
+        M tocaIzquierda = S::y(S::menorIgual(entradaIzquierda, salidaIzquierda), S::menor(cero, salidaIzquierda));
+        M tocaDerecha = S::y(S::menorIgual(entradaDerecha, salidaDerecha), S::menor(cero, salidaDerecha));
+
+        // Si ya estaba dentro (la paleta se movio encima) se empuja afuera por el frente, como antes
+        M dentroIzquierda = S::y(tocaIzquierda, S::menor(entradaIzquierda, cero));
+        M dentroDerecha = S::y(tocaDerecha, S::menor(entradaDerecha, cero));
+        F tiempoIzquierda = S::elegir(tocaIzquierda, S::maximo(entradaIzquierda, cero), infinito);
+        F tiempoDerecha = S::elegir(tocaDerecha, S::maximo(entradaDerecha, cero), infinito);
+
+        F tiempo = S::minimo(tiempoPared, S::minimo(tiempoIzquierda, tiempoDerecha));
+
+        // Delanteras: mismas cuentas; si ya estaba dentro sale por la cara de la que venia
+        F tiempoDelanteraIzquierda, tiempoDelanteraDerecha;
+        M ladoDelanteraIzquierda, ladoDelanteraDerecha, dentroDelanteraIzquierda, dentroDelanteraDerecha;
+        if constexpr (CUATRO_PALETAS) {
+            F entradaDI, salidaDI, entradaDD, salidaDD;
+            cruzarPaleta<S>(x, y, inversaX, inversaY, delanteraIzquierdaX0, delanteraIzquierdaY0, delanteraIzquierdaX1, delanteraIzquierdaY1,
+                entradaDI, salidaDI, ladoDelanteraIzquierda);
+            cruzarPaleta<S>(x, y, inversaX, inversaY, delanteraDerechaX0, delanteraDerechaY0, delanteraDerechaX1, delanteraDerechaY1,
+                entradaDD, salidaDD, ladoDelanteraDerecha);
+            M tocaDI = S::y(S::menorIgual(entradaDI, salidaDI), S::menor(cero, salidaDI));
+            M tocaDD = S::y(S::menorIgual(entradaDD, salidaDD), S::menor(cero, salidaDD));
+            dentroDelanteraIzquierda = S::y(tocaDI, S::menor(entradaDI, cero));
+            dentroDelanteraDerecha = S::y(tocaDD, S::menor(entradaDD, cero));
+            tiempoDelanteraIzquierda = S::elegir(tocaDI, S::maximo(entradaDI, cero), infinito);
+            tiempoDelanteraDerecha = S::elegir(tocaDD, S::maximo(entradaDD, cero), infinito);
+            tiempo = S::minimo(tiempo, S::minimo(tiempoDelanteraIzquierda, tiempoDelanteraDerecha));
+        }
+        M golpea = S::menorIgual(tiempo, restante);
+        if (!S::bits(golpea)) break;
+
+        // Avanzar hasta el golpe (o todo lo que queda si no hay)
+        F avance = S::elegir(golpea, tiempo, restante);
+        x = S::sumar(x, S::multiplicar(vx, avance));
+        y = S::sumar(y, S::multiplicar(vy, avance));
+        impacto = S::elegir(S::y(golpea, S::menor(impacto, cero)), S::restar(S::repetir(dt), S::restar(restante, avance)), impacto);
+        restante = S::restar(restante, avance);
+
+        // Quien gano: primero pared, despues paleta izquierda, despues derecha
+        M esPared = S::y(golpea, S::igual(tiempo, tiempoPared));
+        M esIzquierda = S::yNo(esPared, S::y(golpea, S::igual(tiempo, tiempoIzquierda)));
+        M esDerecha = S::yNo(S::o(esPared, esIzquierda), S::y(golpea, S::igual(tiempo, tiempoDerecha)));
+
+        M frenteIzquierda = S::y(esIzquierda, S::o(ladoIzquierda, dentroIzquierda));
+        M frenteDerecha = S::y(esDerecha, S::o(ladoDerecha, dentroDerecha));
+        M cantoPaleta = S::yNo(S::o(frenteIzquierda, frenteDerecha), S::o(esIzquierda, esDerecha));
+
+        x = S::elegir(S::y(esIzquierda, dentroIzquierda), izquierdaX1, x);
+        x = S::elegir(S::y(esDerecha, dentroDerecha), derechaX0, x);
+        if constexpr (CUATRO_PALETAS) {
+            M antes = S::o(S::o(esPared, esIzquierda), esDerecha);
+            M esDI = S::yNo(antes, S::y(golpea, S::igual(tiempo, tiempoDelanteraIzquierda)));
+            M esDD = S::yNo(S::o(antes, esDI), S::y(golpea, S::igual(tiempo, tiempoDelanteraDerecha)));
+            M frenteDI = S::y(esDI, S::o(ladoDelanteraIzquierda, dentroDelanteraIzquierda));
+            M frenteDD = S::y(esDD, S::o(ladoDelanteraDerecha, dentroDelanteraDerecha));
+            M haciaDerecha = S::menor(cero, vx);
+            x = S::elegir(S::y(esDI, dentroDelanteraIzquierda), S::elegir(haciaDerecha, delanteraIzquierdaX0, delanteraIzquierdaX1), x);
+            x = S::elegir(S::y(esDD, dentroDelanteraDerecha), S::elegir(haciaDerecha, delanteraDerechaX0, delanteraDerechaX1), x);
+            vx = S::elegir(S::o(frenteDI, frenteDD), S::negar(vx), vx);
+            cantoPaleta = S::o(cantoPaleta, S::yNo(S::o(frenteDI, frenteDD), S::o(esDI, esDD)));
+            esIzquierda = S::o(esIzquierda, esDI);
+            esDerecha = S::o(esDerecha, esDD);
+        }
+        vx = S::elegir(frenteIzquierda, S::absoluto(vx), vx);
+        vx = S::elegir(frenteDerecha, S::negar(S::absoluto(vx)), vx);
+        vy = S::elegir(S::o(esPared, cantoPaleta), S::negar(vy), vy);
+
+        golpesPared = S::o(golpesPared, esPared);
+        golpesIzquierda = S::o(golpesIzquierda, esIzquierda);
+        golpesDerecha = S::o(golpesDerecha, esDerecha);
+    }
+
+    // Lo que queda del paso sin mas choques
+    x = S::sumar(x, S::multiplicar(vx, restante));
+    y = S::minimo(S::maximo(S::sumar(y, S::multiplicar(vy, restante)), techo), piso);
+
+    S::guardar(pelotas.x + i, x);
+    S::guardar(pelotas.y + i, y);
+    S::guardar(pelotas.vx + i, vx);
+    S::guardar(pelotas.vy + i, vy);
+    if (pelotas.impacto) S::guardar(pelotas.impacto + i, impacto);
+
+    int pared = S::bits(golpesPared), izquierda = S::bits(golpesIzquierda), derecha = S::bits(golpesDerecha);
+    for (int k = 0; k < S::ANCHO; k++) {
+        pelotas.golpes[i + k] = (uint8_t)(((pared >> k) & 1) * GOLPE_PARED
+            | ((izquierda >> k) & 1) * GOLPE_PALETA_IZQUIERDA
+            | ((derecha >> k) & 1) * GOLPE_PALETA_DERECHA);
+    }
+}
+
+
+// Recorre todas las pelotas con el conjunto de instrucciones mas ancho disponible, el resto de a una
+template <bool PALETA_POR_PELOTA, bool CUATRO_PALETAS = false>
+inline void barrerPelotasCon(pelotasColision& pelotas, const paletasColision& paletas, const geometriaColision& geometria, float dt,
+    const paletasColision* delanteras = nullptr) {
+    int i = 0;
+#if COLISION_AVX2
+    for (; i + simdAVX2::ANCHO <= pelotas.cantidad; i += simdAVX2::ANCHO) {
+        barrerBloque<simdAVX2, PALETA_POR_PELOTA, CUATRO_PALETAS>(pelotas, paletas, geometria, dt, i, delanteras);
+    }
+#endif
+#if COLISION_SSE2
+    for (; i + simdSSE2::ANCHO <= pelotas.cantidad; i += simdSSE2::ANCHO) {
+        barrerBloque<simdSSE2, PALETA_POR_PELOTA, CUATRO_PALETAS>(pelotas, paletas, geometria, dt, i, delanteras);
+    }
+#endif
+    for (; i < pelotas.cantidad; i++) {
+        barrerBloque<simdEscalar, PALETA_POR_PELOTA, CUATRO_PALETAS>(pelotas, paletas, geometria, dt, i, delanteras);
+    }
+}
+
+
+// Todas las pelotas contra el mismo par de paletas (partida normal o multibola)
+inline void barrerPelotas(pelotasColision& pelotas, const paletasColision& paletas, const geometriaColision& geometria, float dt) {
+    barrerPelotasCon<false>(pelotas, paletas, geometria, dt);
+}
+
+
+// Lo mismo con las paletas delanteras de la variante de cuatro paletas
+inline void barrerPelotasCuatro(pelotasColision& pelotas, const paletasColision& paletas, const paletasColision& delanteras,
+    const geometriaColision& geometria, float dt) {
+    barrerPelotasCon<false, true>(pelotas, paletas, geometria, dt, &delanteras);
+}
+
+
+// Cada pelota contra sus propias paletas (una partida por pelota, simulacion por lotes)
+inline void barrerPelotasPorPartida(pelotasColision& pelotas, const paletasColision& paletas, const geometriaColision& geometria, float dt) {
+    barrerPelotasCon<true>(pelotas, paletas, geometria, dt);
+}
@@ -0,0 +1,199 @@
+#include <SDL.h>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "paquete.h"
+
+// Herramienta aparte: junta las imagenes, sonidos y la fuente que usa el juego en un solo
+// assets/pong.pak, ya convertidos a lo que el juego necesita en memoria.
+// Uso: empaquetador <carpeta de recursos> <archivo de salida>
+
+
+struct recursoAEmpaquetar {
+    const char* archivo;
+    tipoRecurso tipo;
+};
+
+
+// Solo lo que el juego carga; las otras variantes de Arial y la estrella de la muerte no se usan
+const recursoAEmpaquetar RECURSOS[] = {
+    { "star-wars-fondo.bmp", RECURSO_TEXTURA },
+    { "sable-rojo.bmp", RECURSO_TEXTURA },
+    { "sable-azul.bmp", RECURSO_TEXTURA },
+    { "rebote_laser.wav", RECURSO_SONIDO },
+    { "gol_grito.wav", RECURSO_SONIDO },
+    { "musica_starwars_inspirada.wav", RECURSO_SONIDO },
+    { "arial.ttf", RECURSO_FUENTE },
+};
+
+
+// Agrega un entero en little endian, como lo espera el formato WAV
+void escribirEntero(std::vector<uint8_t>& datos, uint32_t valor, int bytes) {
+    for (int i = 0; i < bytes; i++) datos.push_back((uint8_t)(valor >> (8 * i)));
+}
+
+
+// BMP a pixeles ARGB8888 sin relleno entre filas
+bool convertirImagen(const std::string& ruta, entradaPaquete& entrada, std::vector<uint8_t>& datos) {
+    SDL_Surface* original = SDL_LoadBMP(ruta.c_str());
+    if (!original) {
+        std::cerr << "Error cargando " << ruta << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_Surface* convertida = SDL_ConvertSurfaceFormat(original, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(original);
+    if (!convertida) {
+        std::cerr << "Error convirtiendo " << ruta << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    int bytesPorFila = convertida->w * 4;
+    datos.resize((size_t)bytesPorFila * convertida->h);
+    for (int fila = 0; fila < convertida->h; fila++) {
+        memcpy(&datos[(size_t)fila * bytesPorFila], (const uint8_t*)convertida->pixels + (size_t)fila * convertida->pitch, bytesPorFila);
+    }
+
+    entrada.formato = SDL_PIXELFORMAT_ARGB8888;
+    entrada.ancho = convertida->w;
+    entrada.alto = convertida->h;
+    entrada.pitch = bytesPorFila;
+    SDL_FreeSurface(convertida);
+    return true;
+}
+
+
+// WAV en cualquier formato a PCM de 16 bits, estereo, 44100 Hz, con su cabecera WAV
+bool convertirSonido(const std::string& ruta, entradaPaquete& entrada, std::vector<uint8_t>& datos) {
+    SDL_AudioSpec formato;
+    Uint8* muestras = nullptr;
+    Uint32 largo = 0;
+    if (!SDL_LoadWAV(ruta.c_str(), &formato, &muestras, &largo)) {
+        std::cerr << "Error cargando " << ruta << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    SDL_AudioCVT conversion;
+    if (SDL_BuildAudioCVT(&conversion, formato.format, formato.channels, formato.freq, AUDIO_S16LSB, CANALES_MEZCLADOR, FRECUENCIA_MEZCLADOR) < 0) {
+        std::cerr << "Error preparando la conversion de " << ruta << ": " << SDL_GetError() << std::endl;
+        SDL_FreeWAV(muestras);
+        return false;
+    }
+    std::vector<uint8_t> pcm((size_t)largo * (conversion.len_mult > 0 ? conversion.len_mult : 1));
+    memcpy(pcm.data(), muestras, largo);
+    SDL_FreeWAV(muestras);
+    conversion.buf = pcm.data();
+    conversion.len = (int)largo;
+    if (conversion.needed && SDL_ConvertAudio(&conversion) < 0) {
+        std::cerr << "Error convirtiendo " << ruta << ": " << SDL_GetError() << std::endl;
+        return false;
+    }
+    uint32_t bytes = conversion.needed ? (uint32_t)conversion.len_cvt : largo;
+
+    // Cabecera WAV canonica: Mix_LoadWAV_RW y Mix_LoadMUS_RW la leen si el mezclador abrio otro formato
+    uint32_t bytesPorSegundo = FRECUENCIA_MEZCLADOR * CANALES_MEZCLADOR * 2;
+    datos.clear();
+    datos.insert(datos.end(), { 'R', 'I', 'F', 'F' });
+    escribirEntero(datos, 36 + bytes, 4);
+    datos.insert(datos.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+    escribirEntero(datos, 16, 4);
+    escribirEntero(datos, 1, 2); // PCM
+    escribirEntero(datos, CANALES_MEZCLADOR, 2);
+    escribirEntero(datos, FRECUENCIA_MEZCLADOR, 4);
+    escribirEntero(datos, bytesPorSegundo, 4);
+    escribirEntero(datos, CANALES_MEZCLADOR * 2, 2);
+    escribirEntero(datos, 16, 2);
+    datos.insert(datos.end(), { 'd', 'a', 't', 'a' });
+    escribirEntero(datos, bytes, 4);
+    datos.insert(datos.end(), pcm.begin(), pcm.begin() + bytes);
+
+    entrada.formato = AUDIO_S16LSB;
+    entrada.frecuencia = FRECUENCIA_MEZCLADOR;
+    entrada.canales = CANALES_MEZCLADOR;
+    return true;
+}
+
+
+// La fuente va tal cual, TTF_OpenFontRW la lee desde la memoria mapeada
+bool copiarArchivo(const std::string& ruta, std::vector<uint8_t>& datos) {
+    FILE* archivo = fopen(ruta.c_str(), "rb");
+    if (!archivo) {
+        std::cerr << "Error abriendo " << ruta << std::endl;
+        return false;
+    }
+    fseek(archivo, 0, SEEK_END);
+    long tamanio = ftell(archivo);
+    fseek(archivo, 0, SEEK_SET);
+    datos.resize(tamanio > 0 ? (size_t)tamanio : 0);
+    bool leido = fread(datos.data(), 1, datos.size(), archivo) == datos.size();
+    fclose(archivo);
+    if (!leido) std::cerr << "Error leyendo " << ruta << std::endl;
+    return leido;
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Uso: empaquetador <carpeta de recursos> <archivo de salida>" << std::endl;
+        return 1;
+    }
+    std::string carpeta = argv[1];
+    if (!carpeta.empty() && carpeta.back() != '/' && carpeta.back() != '\\') carpeta += '/';
+
+    const int cantidad = (int)(sizeof(RECURSOS) / sizeof(RECURSOS[0]));
+    std::vector<entradaPaquete> entradas(cantidad);
+    std::vector<std::vector<uint8_t>> datos(cantidad);
+
+    for (int i = 0; i < cantidad; i++) {
+        entradaPaquete& entrada = entradas[i];
+        memset(&entrada, 0, sizeof(entrada));
+        strncpy(entrada.nombre, RECURSOS[i].archivo, sizeof(entrada.nombre) - 1);
+        entrada.tipo = RECURSOS[i].tipo;
+
+        std::string ruta = carpeta + RECURSOS[i].archivo;
+        bool correcto = false;
+        if (entrada.tipo == RECURSO_TEXTURA) correcto = convertirImagen(ruta, entrada, datos[i]);
+        else if (entrada.tipo == RECURSO_SONIDO) correcto = convertirSonido(ruta, entrada, datos[i]);
+        else correcto = copiarArchivo(ruta, datos[i]);
+        if (!correcto) return 1;
+    }
+
+    // Ubicar cada recurso despues del indice, alineado
+    uint64_t posicion = sizeof(cabeceraPaquete) + (uint64_t)cantidad * sizeof(entradaPaquete);
+    for (int i = 0; i < cantidad; i++) {
+        posicion = (posicion + ALINEACION_PAQUETE - 1) / ALINEACION_PAQUETE * ALINEACION_PAQUETE;
+        entradas[i].inicio = posicion;
+        entradas[i].tamanio = datos[i].size();
+        posicion += datos[i].size();
+    }
+
+    FILE* salida = fopen(argv[2], "wb");
+    if (!salida) {
+        std::cerr << "Error creando " << argv[2] << std::endl;
+        return 1;
+    }
+    cabeceraPaquete cabecera;
+    memcpy(cabecera.firma, FIRMA_PAQUETE, sizeof(cabecera.firma));
+    cabecera.version = VERSION_PAQUETE;
+    cabecera.cantidad = (uint32_t)cantidad;
+    fwrite(&cabecera, sizeof(cabecera), 1, salida);
+    fwrite(entradas.data(), sizeof(entradaPaquete), cantidad, salida);
+
+    const uint8_t relleno[ALINEACION_PAQUETE] = {};
+    uint64_t escrito = sizeof(cabecera) + (uint64_t)cantidad * sizeof(entradaPaquete);
+    for (int i = 0; i < cantidad; i++) {
+        fwrite(relleno, 1, (size_t)(entradas[i].inicio - escrito), salida);
+        fwrite(datos[i].data(), 1, datos[i].size(), salida);
+        escrito = entradas[i].inicio + datos[i].size();
+        std::cout << entradas[i].nombre << ": " << datos[i].size() << " bytes" << std::endl;
+    }
+
+    bool correcto = !ferror(salida);
+    fclose(salida);
+    if (!correcto) {
+        std::cerr << "Error escribiendo " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << "Paquete " << argv[2] << ": " << escrito << " bytes" << std::endl;
+    return 0;
+}
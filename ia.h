@@ -0,0 +1,105 @@
+#pragma once
+#include <math.h>
+#include "simulacion.h"
+
+// Jugador de la computadora. No simula la pelota: calcula donde va a cruzar la linea de su paleta
+// desdoblando los rebotes en las paredes de arriba y abajo (la pelota sigue derecho en una cancha
+// reflejada infinitas veces y al final se vuelve a doblar), asi cada decision es O(1).
+// La dificultad sale de tres cosas: cada cuanto decide (y cuanto tarda en reaccionar cuando la pelota
+// cambia de direccion), cuanto se equivoca al predecir y que tan rapido mueve la paleta.
+
+
+enum nivelDificultad { IA_FACIL, IA_NORMAL, IA_DIFICIL, TOTAL_NIVELES_IA };
+
+
+struct dificultadIA {
+    const char* nombre;
+    float reaccion; // Segundos entre decisiones, y despues de que la pelota cambia de direccion
+    float error; // Pixeles que se equivoca en cada llegada de la pelota (al azar, de -error a error)
+    float ruido; // Error de mas en cada decision, en pixeles por cada segundo que le falta a la pelota
+    float velocidad; // Fraccion de VELOCIDAD_PALETA
+};
+
+
+const dificultadIA DIFICULTADES_IA[TOTAL_NIVELES_IA] = {
+    { "Facil", 0.35f, 100, 90, 0.55f },
+    { "Normal", 0.18f, 80, 45, 0.8f },
+    { "Dificil", 0.06f, 65, 12, 1.0f },
+};
+
+
+// La parte de arriba de la pelota va de 0 a RECORRIDO_PELOTA, igual que en GEOMETRIA_CANCHA
+const float RECORRIDO_PELOTA = (float)(ALTURA_VENTANA - TAMANIO_PELOTA);
+
+
+struct jugadorIA {
+    nivelDificultad nivel = IA_NORMAL;
+    float objetivo = ALTURA_VENTANA / 2.0f; // Donde quiere tener el centro de la paleta
+    float espera = 0; // Segundos hasta la proxima decision
+    bool acercandose = false; // La pelota venia hacia su lado en la ultima decision
+    float sesgo = 0; // Error de esta llegada de la pelota
+    uint32_t azar = 1;
+};
+
+
+inline void reiniciarIA(jugadorIA& ia, nivelDificultad nivel, uint32_t semilla) {
+    ia.nivel = nivel;
+    ia.objetivo = ALTURA_VENTANA / 2.0f;
+    ia.espera = 0;
+    ia.acercandose = false;
+    ia.sesgo = 0;
+    ia.azar = semilla ? semilla : 1;
+}
+
+
+// Y de la parte de arriba de la pelota cuando llegue a x = planoX (la pelota tiene que ir hacia el plano)
+inline float predecirCruce(float x, float y, float vx, float vy, float planoX) {
+    float desdoblada = y + vy * ((planoX - x) / vx);
+    float periodo = 2 * RECORRIDO_PELOTA;
+    float resto = fmodf(desdoblada, periodo);
+    if (resto < 0) resto += periodo;
+    return resto <= RECORRIDO_PELOTA ? resto : periodo - resto;
+}
+
+
+// Actualiza el objetivo si ya toca decidir; devuelve donde quiere el centro de la paleta
+inline float objetivoIA(jugadorIA& ia, float paletaX, bool derecha, const pelota& bola, float dt) {
+    const dificultadIA& dificultad = DIFICULTADES_IA[ia.nivel];
+    bool acercandose = derecha ? bola.vx > 0 : bola.vx < 0;
+    if (acercandose != ia.acercandose) {
+        ia.acercandose = acercandose;
+        ia.espera = dificultad.reaccion;
+        ia.sesgo = azarCentrado(ia.azar) * dificultad.error;
+    }
+    ia.espera -= dt;
+    if (ia.espera > 0) return ia.objetivo;
+    ia.espera = dificultad.reaccion;
+
+    // Si la pelota se aleja vuelve al centro; si viene, a donde va a cruzar, con mas error cuanto mas lejos
+    float planoX = derecha ? paletaX - TAMANIO_PELOTA : paletaX + ANCHO_PALETA;
+    float tiempo = (planoX - bola.x) / bola.vx;
+    if (!acercandose || tiempo < 0) {
+        ia.objetivo = ALTURA_VENTANA / 2.0f;
+        return ia.objetivo;
+    }
+    float cruce = predecirCruce(bola.x, bola.y, bola.vx, bola.vy, planoX);
+    ia.objetivo = cruce + TAMANIO_PELOTA / 2.0f + ia.sesgo + azarCentrado(ia.azar) * dificultad.ruido * tiempo;
+    return ia.objetivo;
+}
+
+
+// Pone las teclas de un lado con lo que decide la IA; las fracciones del paso limitan la velocidad
+// y evitan que la paleta tiemble alrededor del objetivo
+inline void teclasIA(jugadorIA& ia, const estadoSimulacion& estado, bool derecha, float dt, entradasPaso& teclas) {
+    const paleta& propia = derecha ? estado.paletaDerecha : estado.paletaIzquierda;
+    float diferencia = objetivoIA(ia, propia.x, derecha, estado.pelota, dt) - (propia.y + ALTURA_PALETA / 2.0f);
+    float fraccion = fabsf(diferencia) / (VELOCIDAD_PALETA * dt);
+    if (fraccion > 1) fraccion = 1;
+    uint8_t valor = (uint8_t)(fraccion * DIFICULTADES_IA[ia.nivel].velocidad * 255 + 0.5f);
+
+    // Indices de teclaEntrada: 0-3 la izquierda, 4-7 la derecha (arriba, abajo, izquierda, derecha)
+    uint8_t* lado = teclas.presionada + (derecha ? 4 : 0);
+    lado[0] = diferencia < 0 ? valor : 0;
+    lado[1] = diferencia > 0 ? valor : 0;
+    lado[2] = lado[3] = 0;
+}
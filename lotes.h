@@ -0,0 +1,393 @@
+#pragma once
+#include "simulacion.h"
+#include "ia.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Simulacion por lotes sin ventana ni sonido (--headless), para ajustar las constantes del juego
+
+
+// Valores que se pueden cambiar desde la linea de comandos sin recompilar
+struct parametrosJuego {
+    float velocidadPelota = VELOCIDAD_PELOTA;
+    float velocidadPaleta = VELOCIDAD_PALETA;
+    int alturaPaleta = ALTURA_PALETA;
+    int puntajeGanador = PUNTAJE_GANADOR;
+};
+
+
+// Como se eligen las teclas de cada paleta
+enum modoEntradas { IA_SEGUIR, ENTRADAS_ALEATORIAS, IA_PREDICTIVA };
+
+
+struct configuracionLotes {
+    parametrosJuego parametros;
+    modoEntradas modo = IA_SEGUIR;
+    nivelDificultad nivel = IA_DIFICIL; // Para IA_PREDICTIVA, las dos paletas
+    long long partidas = 100000;
+    int hilos = 0; // 0 = todos los nucleos
+    int partidasPorHilo = 4096; // Partidas simuladas a la vez por cada hilo
+    uint32_t semilla = 1;
+};
+
+
+// Partidas guardadas como estructura de arreglos: cada campo de todas las partidas esta contiguo
+struct loteDePartidas {
+    int cantidad = 0;
+    std::vector<float> izquierdaX, izquierdaY, derechaX, derechaY;
+    std::vector<float> pelotaX, pelotaY, pelotaVX, pelotaVY;
+    std::vector<int> puntajeIzquierda, puntajeDerecha;
+    std::vector<int> golpesDelPunto, pasosDelPunto;
+    std::vector<float> errorIzquierda, errorDerecha; // Donde apunta la IA respecto al centro de la paleta
+    std::vector<jugadorIA> iaIzquierda, iaDerecha; // Solo con IA_PREDICTIVA
+    std::vector<uint8_t> teclas;
+    std::vector<uint8_t> golpes; // Salida del nucleo de colisiones
+    std::vector<uint8_t> activa;
+    std::vector<uint32_t> azar;
+};
+
+
+// Totales de un hilo, despues se suman
+struct estadisticasLotes {
+    long long partidas = 0;
+    long long victoriasIzquierda = 0;
+    long long victoriasDerecha = 0;
+    long long puntos = 0;
+    long long golpes = 0;
+    long long pasos = 0; // Pasos de partidas activas
+    long long empates = 0; // Partidas cortadas porque un punto no terminaba nunca
+    int rallyMasLargo = 0;
+};
+
+
+// Mismo reinicio que reiniciarPelota pero con la velocidad configurada
+inline void reiniciarPelotaLote(loteDePartidas& lote, int i, int direccion, const parametrosJuego& parametros) {
+    lote.pelotaX[i] = ANCHO_VENTANA / 2;
+    lote.pelotaY[i] = ALTURA_VENTANA / 2;
+    lote.pelotaVX[i] = direccion * parametros.velocidadPelota;
+    lote.pelotaVY[i] = parametros.velocidadPelota;
+    lote.golpesDelPunto[i] = 0;
+    lote.pasosDelPunto[i] = 0;
+}
+
+
+// Deja la partida i lista para empezar, igual que inicializarSimulacion
+inline void iniciarPartidaLote(loteDePartidas& lote, int i, const parametrosJuego& parametros) {
+    lote.izquierdaX[i] = 50;
+    lote.izquierdaY[i] = (float)(ALTURA_VENTANA / 2 - parametros.alturaPaleta / 2);
+    lote.derechaX[i] = ANCHO_VENTANA - 50 - ANCHO_PALETA;
+    lote.derechaY[i] = (float)(ALTURA_VENTANA / 2 - parametros.alturaPaleta / 2);
+    lote.puntajeIzquierda[i] = 0;
+    lote.puntajeDerecha[i] = 0;
+    lote.errorIzquierda[i] = azarCentrado(lote.azar[i]) * parametros.alturaPaleta / 2;
+    lote.errorDerecha[i] = azarCentrado(lote.azar[i]) * parametros.alturaPaleta / 2;
+    reiniciarIA(lote.iaIzquierda[i], lote.iaIzquierda[i].nivel, siguienteAzar(lote.azar[i]));
+    reiniciarIA(lote.iaDerecha[i], lote.iaDerecha[i].nivel, siguienteAzar(lote.azar[i]));
+    lote.activa[i] = 1;
+    reiniciarPelotaLote(lote, i, 1, parametros);
+}
+
+
+inline void crearLote(loteDePartidas& lote, int cantidad, uint32_t semilla, const parametrosJuego& parametros, nivelDificultad nivel = IA_DIFICIL) {
+    lote.cantidad = cantidad;
+    for (std::vector<float>* campo : { &lote.izquierdaX, &lote.izquierdaY, &lote.derechaX, &lote.derechaY,
+            &lote.pelotaX, &lote.pelotaY, &lote.pelotaVX, &lote.pelotaVY, &lote.errorIzquierda, &lote.errorDerecha }) {
+        campo->assign(cantidad, 0.0f);
+    }
+    lote.puntajeIzquierda.assign(cantidad, 0);
+    lote.puntajeDerecha.assign(cantidad, 0);
+    lote.golpesDelPunto.assign(cantidad, 0);
+    lote.pasosDelPunto.assign(cantidad, 0);
+    lote.teclas.assign(cantidad, 0);
+    lote.golpes.assign(cantidad, 0);
+    lote.activa.assign(cantidad, 0);
+    jugadorIA ia;
+    ia.nivel = nivel;
+    lote.iaIzquierda.assign(cantidad, ia);
+    lote.iaDerecha.assign(cantidad, ia);
+    lote.azar.resize(cantidad);
+    for (int i = 0; i < cantidad; i++) {
+        // El estado de xorshift nunca puede ser 0
+        lote.azar[i] = (semilla * 2654435761u) ^ (uint32_t)(i * 40503u + 1u);
+        if (!lote.azar[i]) lote.azar[i] = 1;
+        iniciarPartidaLote(lote, i, parametros);
+    }
+}
+
+
+// Un punto que dura mas de un minuto de juego corta la partida como empate, si no una IA perfecta no terminaria nunca
+const int MAXIMO_PASOS_POR_PUNTO = 60 * 120;
+
+
+// Elige las teclas de todas las partidas para el siguiente paso
+inline void elegirEntradasLote(loteDePartidas& lote, modoEntradas modo, const parametrosJuego& parametros) {
+    const float mitadPaleta = parametros.alturaPaleta / 2.0f;
+    const float centroPelota = TAMANIO_PELOTA / 2.0f;
+
+    if (modo == ENTRADAS_ALEATORIAS) {
+        // Cambia de teclas unas 4 veces por segundo
+        for (int i = 0; i < lote.cantidad; i++) {
+            if ((lote.pasosDelPunto[i] % 30) == 0) lote.teclas[i] = (uint8_t)siguienteAzar(lote.azar[i]);
+        }
+        return;
+    }
+
+    // La IA del juego: predice el cruce de la pelota y va hacia ahi. Con teclas enteras no hay fracciones
+    // del paso: la velocidad de la dificultad se logra apretando solo en esa fraccion de los pasos,
+    // con el nivel de cada paleta.
+    // La prediccion corre en todos los pasos, como en el juego, para que la reaccion no se estire
+    if (modo == IA_PREDICTIVA) {
+        const float margen = parametros.velocidadPaleta * PASO_SIMULACION / 2;
+        for (int i = 0; i < lote.cantidad; i++) {
+            pelota bola = { lote.pelotaX[i], lote.pelotaY[i], lote.pelotaVX[i], lote.pelotaVY[i] };
+            float izquierda = objetivoIA(lote.iaIzquierda[i], lote.izquierdaX[i], false, bola, PASO_SIMULACION) - (lote.izquierdaY[i] + mitadPaleta);
+            float derecha = objetivoIA(lote.iaDerecha[i], lote.derechaX[i], true, bola, PASO_SIMULACION) - (lote.derechaY[i] + mitadPaleta);
+            float velocidadIzquierda = DIFICULTADES_IA[lote.iaIzquierda[i].nivel].velocidad;
+            float velocidadDerecha = DIFICULTADES_IA[lote.iaDerecha[i].nivel].velocidad;
+            int paso = lote.pasosDelPunto[i];
+            bool mueveIzquierda = (int)((paso + 1) * velocidadIzquierda) != (int)(paso * velocidadIzquierda);
+            bool mueveDerecha = (int)((paso + 1) * velocidadDerecha) != (int)(paso * velocidadDerecha);
+            uint8_t teclas = 0;
+            if (mueveIzquierda) {
+                teclas |= izquierda < -margen ? IZQUIERDA_ARRIBA : 0;
+                teclas |= izquierda > margen ? IZQUIERDA_ABAJO : 0;
+            }
+            if (mueveDerecha) {
+                teclas |= derecha < -margen ? DERECHA_ARRIBA : 0;
+                teclas |= derecha > margen ? DERECHA_ABAJO : 0;
+            }
+            lote.teclas[i] = teclas;
+        }
+        return;
+    }
+
+    // La IA solo sube o baja hacia la pelota, con un error distinto en cada partida
+    for (int i = 0; i < lote.cantidad; i++) {
+        float objetivo = lote.pelotaY[i] + centroPelota;
+        float izquierda = lote.izquierdaY[i] + mitadPaleta + lote.errorIzquierda[i];
+        float derecha = lote.derechaY[i] + mitadPaleta + lote.errorDerecha[i];
+        uint8_t teclas = 0;
+        teclas |= objetivo < izquierda - 4 ? IZQUIERDA_ARRIBA : 0;
+        teclas |= objetivo > izquierda + 4 ? IZQUIERDA_ABAJO : 0;
+        teclas |= objetivo < derecha - 4 ? DERECHA_ARRIBA : 0;
+        teclas |= objetivo > derecha + 4 ? DERECHA_ABAJO : 0;
+        lote.teclas[i] = teclas;
+    }
+}
+
+
+// Avanza un paso todas las partidas, con las mismas reglas que avanzarSimulacion
+inline void avanzarLote(loteDePartidas& lote, const parametrosJuego& parametros, float dt) {
+    const float distanciaPaleta = parametros.velocidadPaleta * dt;
+    const float limiteY = (float)(ALTURA_VENTANA - parametros.alturaPaleta);
+    const float limiteIzquierdaX = (float)(ANCHO_VENTANA / 2 - ANCHO_PALETA);
+    const float minimoDerechaX = (float)(ANCHO_VENTANA / 2);
+    const float limiteDerechaX = (float)(ANCHO_VENTANA - ANCHO_PALETA);
+    const int n = lote.cantidad;
+
+    float* izquierdaX = lote.izquierdaX.data();
+    float* izquierdaY = lote.izquierdaY.data();
+    float* derechaX = lote.derechaX.data();
+    float* derechaY = lote.derechaY.data();
+    const uint8_t* teclas = lote.teclas.data();
+
+    // Paletas: sin saltos, el compilador puede vectorizar este ciclo
+    for (int i = 0; i < n; i++) {
+        uint8_t t = teclas[i];
+        izquierdaY[i] -= (t & IZQUIERDA_ARRIBA) && izquierdaY[i] > 0 ? distanciaPaleta : 0.0f;
+        izquierdaY[i] += (t & IZQUIERDA_ABAJO) && izquierdaY[i] < limiteY ? distanciaPaleta : 0.0f;
+        izquierdaX[i] -= (t & IZQUIERDA_IZQUIERDA) && izquierdaX[i] > 0 ? distanciaPaleta : 0.0f;
+        izquierdaX[i] += (t & IZQUIERDA_DERECHA) && izquierdaX[i] < limiteIzquierdaX ? distanciaPaleta : 0.0f;
+        derechaY[i] -= (t & DERECHA_ARRIBA) && derechaY[i] > 0 ? distanciaPaleta : 0.0f;
+        derechaY[i] += (t & DERECHA_ABAJO) && derechaY[i] < limiteY ? distanciaPaleta : 0.0f;
+        derechaX[i] -= (t & DERECHA_IZQUIERDA) && derechaX[i] > minimoDerechaX ? distanciaPaleta : 0.0f;
+        derechaX[i] += (t & DERECHA_DERECHA) && derechaX[i] < limiteDerechaX ? distanciaPaleta : 0.0f;
+    }
+
+    // Pelotas: cada una contra las paletas de su partida, varias partidas por instruccion
+    geometriaColision geometria = GEOMETRIA_CANCHA;
+    geometria.alturaPaleta = (float)parametros.alturaPaleta;
+    pelotasColision pelotas = { lote.pelotaX.data(), lote.pelotaY.data(), lote.pelotaVX.data(), lote.pelotaVY.data(), lote.golpes.data(), nullptr, n };
+    paletasColision paletas = { izquierdaX, izquierdaY, derechaX, derechaY };
+    barrerPelotasPorPartida(pelotas, paletas, geometria, dt);
+
+    // La IA cambia de punteria despues de cada golpe de su paleta
+    for (int i = 0; i < n; i++) {
+        lote.pasosDelPunto[i]++;
+        uint8_t golpes = lote.golpes[i];
+        if (!(golpes & (GOLPE_PALETA_IZQUIERDA | GOLPE_PALETA_DERECHA))) continue;
+        if (golpes & GOLPE_PALETA_IZQUIERDA) {
+            lote.golpesDelPunto[i]++;
+            lote.errorIzquierda[i] = azarCentrado(lote.azar[i]) * parametros.alturaPaleta / 2;
+        }
+        if (golpes & GOLPE_PALETA_DERECHA) {
+            lote.golpesDelPunto[i]++;
+            lote.errorDerecha[i] = azarCentrado(lote.azar[i]) * parametros.alturaPaleta / 2;
+        }
+    }
+}
+
+
+// Anota los puntos del paso, suma estadisticas y reinicia las partidas terminadas
+inline void anotarPuntosLote(loteDePartidas& lote, const parametrosJuego& parametros, estadisticasLotes& estadisticas, long long& partidasPendientes) {
+    for (int i = 0; i < lote.cantidad; i++) {
+        if (!lote.activa[i]) continue;
+        estadisticas.pasos++;
+
+        int direccion = 0;
+        if (lote.pelotaX[i] + TAMANIO_PELOTA < 0) {
+            lote.puntajeDerecha[i]++;
+            direccion = 1;
+        }
+        else if (lote.pelotaX[i] > ANCHO_VENTANA) {
+            lote.puntajeIzquierda[i]++;
+            direccion = -1;
+        }
+        bool empate = !direccion && lote.pasosDelPunto[i] > MAXIMO_PASOS_POR_PUNTO;
+        if (!direccion && !empate) continue;
+
+        if (direccion) {
+            estadisticas.puntos++;
+            estadisticas.golpes += lote.golpesDelPunto[i];
+            if (lote.golpesDelPunto[i] > estadisticas.rallyMasLargo) estadisticas.rallyMasLargo = lote.golpesDelPunto[i];
+            reiniciarPelotaLote(lote, i, direccion, parametros);
+        }
+
+        bool ganaIzquierda = lote.puntajeIzquierda[i] >= parametros.puntajeGanador;
+        bool ganaDerecha = lote.puntajeDerecha[i] >= parametros.puntajeGanador;
+        if (!ganaIzquierda && !ganaDerecha && !empate) continue;
+
+        estadisticas.partidas++;
+        estadisticas.victoriasIzquierda += ganaIzquierda;
+        estadisticas.victoriasDerecha += ganaDerecha;
+        estadisticas.empates += empate;
+
+        // Reusar el lugar para otra partida mientras falten
+        if (partidasPendientes > 0) {
+            partidasPendientes--;
+            iniciarPartidaLote(lote, i, parametros);
+        }
+        else {
+            lote.activa[i] = 0;
+        }
+    }
+}
+
+
+// Lo que corre cada hilo: su propio lote hasta terminar sus partidas
+inline void simularPartidasHilo(const configuracionLotes& configuracion, long long partidas, uint32_t semilla, estadisticasLotes& estadisticas) {
+    if (partidas <= 0) return;
+    int cantidad = partidas < configuracion.partidasPorHilo ? (int)partidas : configuracion.partidasPorHilo;
+    long long pendientes = partidas - cantidad;
+
+    loteDePartidas lote;
+    crearLote(lote, cantidad, semilla, configuracion.parametros, configuracion.nivel);
+
+    long long terminadas = 0;
+    while (terminadas < partidas) {
+        elegirEntradasLote(lote, configuracion.modo, configuracion.parametros);
+        avanzarLote(lote, configuracion.parametros, PASO_SIMULACION);
+        anotarPuntosLote(lote, configuracion.parametros, estadisticas, pendientes);
+        terminadas = estadisticas.partidas;
+    }
+}
+
+
+// Lee las opciones de --headless, devuelve false si alguna no se entiende
+inline bool leerConfiguracionLotes(int argc, char* argv[], configuracionLotes& configuracion) {
+    for (int i = 1; i < argc; i++) {
+        const char* opcion = argv[i];
+        const char* valor = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(opcion, "--headless")) continue;
+        if (!valor) {
+            std::fprintf(stderr, "Falta el valor de %s\n", opcion);
+            return false;
+        }
+        if (!strcmp(opcion, "--partidas")) configuracion.partidas = atoll(valor);
+        else if (!strcmp(opcion, "--hilos")) configuracion.hilos = atoi(valor);
+        else if (!strcmp(opcion, "--semilla")) configuracion.semilla = (uint32_t)strtoul(valor, nullptr, 10);
+        else if (!strcmp(opcion, "--velocidad-pelota")) configuracion.parametros.velocidadPelota = (float)atof(valor);
+        else if (!strcmp(opcion, "--velocidad-paleta")) configuracion.parametros.velocidadPaleta = (float)atof(valor);
+        else if (!strcmp(opcion, "--altura-paleta")) configuracion.parametros.alturaPaleta = atoi(valor);
+        else if (!strcmp(opcion, "--puntaje-ganador")) configuracion.parametros.puntajeGanador = atoi(valor);
+        else if (!strcmp(opcion, "--entradas")) {
+            if (!strcmp(valor, "ia")) configuracion.modo = IA_SEGUIR;
+            else if (!strcmp(valor, "aleatorias")) configuracion.modo = ENTRADAS_ALEATORIAS;
+            else if (!strcmp(valor, "prediccion")) configuracion.modo = IA_PREDICTIVA;
+            else {
+                std::fprintf(stderr, "Entradas desconocidas: %s (ia, aleatorias o prediccion)\n", valor);
+                return false;
+            }
+        }
+        else if (!strcmp(opcion, "--dificultad")) {
+            if (!strcmp(valor, "facil")) configuracion.nivel = IA_FACIL;
+            else if (!strcmp(valor, "normal")) configuracion.nivel = IA_NORMAL;
+            else if (!strcmp(valor, "dificil")) configuracion.nivel = IA_DIFICIL;
+            else {
+                std::fprintf(stderr, "Dificultad desconocida: %s (facil, normal o dificil)\n", valor);
+                return false;
+            }
+        }
+        else {
+            std::fprintf(stderr, "Opcion desconocida: %s\n", opcion);
+            return false;
+        }
+        i++;
+    }
+    return configuracion.partidas > 0 && configuracion.parametros.alturaPaleta > 0 && configuracion.parametros.puntajeGanador > 0;
+}
+
+
+// Punto de entrada de --headless: reparte las partidas entre todos los nucleos e imprime los totales
+inline int ejecutarSinVentana(int argc, char* argv[]) {
+    configuracionLotes configuracion;
+    if (!leerConfiguracionLotes(argc, argv, configuracion)) {
+        std::fprintf(stderr, "Uso: pong --headless [--partidas N] [--hilos N] [--semilla N] [--entradas ia|aleatorias|prediccion]\n"
+            "                     [--dificultad facil|normal|dificil] [--velocidad-pelota V] [--velocidad-paleta V] [--altura-paleta H] [--puntaje-ganador P]\n");
+        return 1;
+    }
+
+    int hilos = configuracion.hilos > 0 ? configuracion.hilos : (int)std::thread::hardware_concurrency();
+    if (hilos < 1) hilos = 1;
+
+    std::vector<estadisticasLotes> porHilo(hilos);
+    std::vector<std::thread> trabajadores;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int h = 0; h < hilos; h++) {
+        long long partidas = configuracion.partidas / hilos + (h < configuracion.partidas % hilos ? 1 : 0);
+        uint32_t semilla = configuracion.semilla + (uint32_t)h * 7919u;
+        trabajadores.emplace_back(simularPartidasHilo, std::cref(configuracion), partidas, semilla, std::ref(porHilo[h]));
+    }
+    for (std::thread& trabajador : trabajadores) trabajador.join();
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    estadisticasLotes total;
+    for (const estadisticasLotes& e : porHilo) {
+        total.partidas += e.partidas;
+        total.victoriasIzquierda += e.victoriasIzquierda;
+        total.victoriasDerecha += e.victoriasDerecha;
+        total.puntos += e.puntos;
+        total.golpes += e.golpes;
+        total.pasos += e.pasos;
+        total.empates += e.empates;
+        if (e.rallyMasLargo > total.rallyMasLargo) total.rallyMasLargo = e.rallyMasLargo;
+    }
+
+    double segundosDeJuego = total.pasos * (double)PASO_SIMULACION;
+    std::printf("Partidas: %lld en %.3f s con %d hilos (%.0f partidas/s, %.1f millones de pasos/s)\n",
+        total.partidas, segundos, hilos, total.partidas / segundos, total.pasos / segundos / 1e6);
+    std::printf("Parametros: pelota %.0f px/s, paleta %.0f px/s, altura %d px, gana con %d\n",
+        configuracion.parametros.velocidadPelota, configuracion.parametros.velocidadPaleta,
+        configuracion.parametros.alturaPaleta, configuracion.parametros.puntajeGanador);
+    std::printf("Victorias: izquierda %.2f%%, derecha %.2f%%, empates %.2f%%\n", 100.0 * total.victoriasIzquierda / total.partidas,
+        100.0 * total.victoriasDerecha / total.partidas, 100.0 * total.empates / total.partidas);
+    std::printf("Rally: %.2f golpes por punto en promedio, el mas largo %d\n",
+        total.puntos ? (double)total.golpes / total.puntos : 0.0, total.rallyMasLargo);
+    std::printf("Puntos por segundo de juego: %.4f (%.2f s por punto)\n",
+        segundosDeJuego > 0 ? total.puntos / segundosDeJuego : 0.0, total.puntos ? segundosDeJuego / total.puntos : 0.0);
+    return 0;
+}
@@ -2,67 +2,168 @@
 #include <SDL_ttf.h>
 #include <iostream>
 #include <string>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
 #include <SDL_mixer.h>
+#include "simulacion.h"
+#include "reglas.h"
+#include "lotes.h"
+#include "caos.h"
+#include "texto.h"
+#include "paquete.h"
+#include "cargador.h"
+#include "perfil.h"
+#include "teclado.h"
+#include "red.h"
+#include "repeticion.h"
+#include "capas.h"
+#include "ritmo.h"
+#include "ia.h"
+#include "audio.h"
+#include "captura.h"
+#include "tareas.h"
 
-// Dimensiones de la ventana
-const int ANCHO_VENTANA = 1200;
-const int ALTURA_VENTANA = 650;
+// Paquete con todos los recursos ya convertidos; si no esta se cargan los archivos sueltos
+const char* const RUTA_PAQUETE = "assets/pong.pak";
 
-// Dimensiones de las paletas y la pelota
-const int ANCHO_PALETA = 15;
-const int ALTURA_PALETA = 90;
-const int TAMANIO_PELOTA = 10;
 
+// Tiempo mximo que se simula por frame, evita la espiral cuando el juego se traba
+const double MAXIMO_TIEMPO_POR_FRAME = 0.25;
 
-// Velocidades
-const int VELOCIDAD_PALETA = 400; // Pxeles por segundo
-const int VELOCIDAD_PELOTA = 500;   // Pxeles por segundo
 
-
-// Lmite de puntuacin para ganar
-const int PUNTAJE_GANADOR = 5;
+// Cuanto salta la repeticion con las flechas izquierda y derecha
+const int32_t SALTO_REPETICION = 5 * PASOS_POR_CLAVE;
 
 
 // Estados del eventoJuego
-enum estadoJuego { MENU, INSTRUCCIONES, JUGANDO, GAME_OVER, SALIR };
+enum estadoJuego { MENU, INSTRUCCIONES, ESPERANDO_RED, JUGANDO, REPRODUCIENDO, GAME_OVER, SALIR };
+
 
+// Opciones del menu en el orden en que se muestran
+enum opcionMenu { OPCION_JUGAR, OPCION_CONTRA_CPU, OPCION_CAOS, OPCION_INSTRUCCIONES, OPCION_SALIR, TOTAL_OPCIONES };
 
-struct paleta {
-    float x, y;
-    int puntaje;
+
+// Textos que nunca cambian, se acomodan una sola vez al iniciar
+enum textoDelJuego {
+    TEXTO_TITULO, TEXTO_JUGAR, TEXTO_CONTRA_CPU, TEXTO_CAOS, TEXTO_INSTRUCCIONES, TEXTO_SALIR,
+    TEXTO_TITULO_INSTRUCCIONES, TEXTO_JUGADOR_IZQUIERDO, TEXTO_W, TEXTO_S,
+    TEXTO_JUGADOR_DERECHO, TEXTO_FLECHA_ARRIBA, TEXTO_FLECHA_ABAJO, TEXTO_VOLVER_ESC,
+    TEXTO_VOLVER_MENU, TOTAL_TEXTOS
 };
 
 
-struct pelota {
-    float x, y;
-    float vx, vy;
+struct textoEnPantalla {
+    const char* texto;
+    int x, y;
 };
 
 
-// Estructura del juego base y menu
-struct pong {
-    SDL_Window* ventana; // Formato de la ventana (tamao, altura, fondo, etc.)
-    SDL_Renderer* renderizar; // Funcion que renderiza todo
-    TTF_Font* fuente; // Fuente del texto
-    paleta paletaIzquierda; 
-    paleta paletaDerecha;
-    pelota pelota;  
-    estadoJuego estadoDeJuego; // Estado en el que se encuentra el eventoJuego
-    int opcionSeleccionada; // Selecciona la opcion correspondiente
-    bool juegoIniciado; // Palanca para iniciar el eventoJuego
-    Uint32 lastTime; // Escencial para que el juego vaya fluido 
-    std::string mensajeGanador; // Almacena el mensaje del ganador
+const textoEnPantalla TEXTOS_DEL_JUEGO[TOTAL_TEXTOS] = {
+    { "Pong", ANCHO_VENTANA / 2 - 50, 100 },
+    { "Jugar", ANCHO_VENTANA / 2 - 50, 200 },
+    { "Contra la CPU", ANCHO_VENTANA / 2 - 50, 250 },
+    { "Caos", ANCHO_VENTANA / 2 - 50, 300 },
+    { "Instrucciones", ANCHO_VENTANA / 2 - 50, 350 },
+    { "Salir", ANCHO_VENTANA / 2 - 50, 400 },
+    { "Instrucciones", ANCHO_VENTANA / 2 - 80, 100 },
+    { "Jugador Izquierdo:", ANCHO_VENTANA / 2 - 80, 200 },
+    { "W: Subir", ANCHO_VENTANA / 2 - 80, 230 },
+    { "S: Bajar", ANCHO_VENTANA / 2 - 80, 260 },
+    { "Jugador Derecho:", ANCHO_VENTANA / 2 - 80, 300 },
+    { "Flecha Arriba: Subir", ANCHO_VENTANA / 2 - 80, 330 },
+    { "Flecha Abajo: Bajar", ANCHO_VENTANA / 2 - 80, 360 },
+    { "Presiona ESC para volver", ANCHO_VENTANA / 2 - 80, 450 },
+    { "Presiona ENTER para volver al men", ANCHO_VENTANA / 2 - 100, ALTURA_VENTANA / 2 + 50 },
+};
+
+
+
+// Buffers del modo caos, reservados al iniciar para dibujar cada tipo de entidad con una sola llamada
+struct dibujoCaos {
+    std::vector<SDL_FRect> pelotas;
+    std::vector<SDL_Vertex> chispas; // 4 vertices por chispa
+    std::vector<int> indicesChispas; // Fijos, se calculan una vez
+};
+
+
+// Lo que hay una sola vez por proceso y comparten todas las partidas. Imagenes, sonidos, atlas y textos
+// fijos no cambian despues de cargarse; ventana, ritmo y perfil los usa solo el hilo principal.
+// Cada partida toma una referencia al iniciarse y la suelta al limpiarse; el ultimo que suelta lo destruye.
+struct recursosJuego {
+    int referencias = 0; // Partidas (y la sala) que lo usan; solo lo toca el hilo principal
+    SDL_Window* ventana = nullptr; // Formato de la ventana (tamao, altura, fondo, etc.)
+    SDL_Renderer* renderizar = nullptr; // Funcion que renderiza todo
+    atlasTexto atlas; // Todos los caracteres de la fuente en una textura
+    textoFijo textos[TOTAL_TEXTOS]; // Textos del menu ya acomodados
+    bool textosListos = false; // Los textos fijos ya se acomodaron con el atlas
+    paqueteRecursos paquete; // assets/pong.pak mapeado en memoria, vive hasta soltarRecursos
+    cargadorRecursos cargador; // Hilos que cargan los recursos mientras se muestra el menu
+    bool musicaIniciada = false; // La musica ya empezo a sonar
+    perfilFrames perfil; // Tiempos de cada etapa del frame, panel con F3
+    ritmoFrames ritmo; // Cuando empieza cada frame: vsync, FPS fijos o pocos FPS en los menus
     Mix_Chunk* sonidoRebote = nullptr; // sonido molesto
     Mix_Chunk* sonidoPunto = nullptr; // Sondio ganador
+    motorAudio audio; // Mezcla los efectos en el hilo de audio, en la muestra del rebote
     Mix_Music* musicaFondo = nullptr; // Musica bolviana
     SDL_Texture* fondo = nullptr; // Imagen del fondo de la pantalla
     SDL_Texture* sableIzquierdo = nullptr; // Imagen de sabel de luz izquierdo
     SDL_Texture* sableDerecho = nullptr; // Imagen de sable de luz derecho
+};
+
+
+// Efectos de un frame; los junta el hilo que simula y los entrega el principal (la cola de audio es de un solo productor)
+const int MAXIMO_EFECTOS_FRAME = 32;
+
+
+struct efectoPendiente {
+    efectoSonido efecto;
+    double momento;
+};
+
+
+// Estructura del juego base y menu: una partida, con su propio estado, menu y vista en la ventana
+struct pong {
+    recursosJuego* recursos; // Compartidos con las otras partidas
+    SDL_Rect vista; // Parte de la ventana donde se dibuja
+    bool enFoco; // Recibe el teclado
+    entradas teclasApretadas; // Teclas apretadas en este frame, leidas en el hilo principal (0 sin el foco)
+    loteTexto lote; // Texto acumulado durante el frame
+    estadoSimulacion simulacion; // Paletas, pelota y puntajes del paso actual
+    estadoSimulacion simulacionAnterior; // Paso anterior, para interpolar al dibujar
+    double acumulador; // Tiempo real que todavia no se simulo
+    bool modoCaos; // La partida es del modo caos (multibola)
+    bool contraCPU; // La paleta derecha la maneja la computadora
+    jugadorIA cpu; // Decisiones de la paleta derecha en contraCPU
+    nivelDificultad dificultad; // Elegida en el menu con izquierda/derecha
+    modoReglas reglas; // Variante elegida en el menu con izquierda/derecha sobre "Jugar"
+    modoReglas reglasPartida; // Variante con la que se simula y se dibuja la partida actual
+    estadoCaos caos; // Pelotas y chispas del modo caos
+    dibujoCaos dibujo; // Buffers para dibujar el modo caos
+    compositorCapas capas; // Pantallas quietas y fondo de la partida ya dibujados en texturas
+    estadoJuego estadoDeJuego; // Estado en el que se encuentra el eventoJuego
+    int opcionSeleccionada; // Selecciona la opcion correspondiente
+    Uint64 lastTime; // Contador de alta resolucion del frame anterior
+    const char* mensajeGanador; // Almacena el mensaje del ganador
+    tecladoConTiempo teclado; // Cambios de teclas con su hora, para repartirlos dentro de cada paso
+    bool modoRed; // Partida en linea: una paleta es local y la otra llega por la red
+    sesionRed red; // Conexion, entradas y estados guardados para el rollback
+    grabadorRepeticion grabador; // Graba la partida clasica o en linea mientras se juega
+    repeticionCargada repeticion; // Repeticion abierta con --repeticion
+    reproductorRepeticion reproductor; // Paso de la repeticion que se esta mostrando
+    int velocidadRepeticion; // 1, 2, 4 ... VELOCIDAD_MAXIMA_REPETICION
+    bool repeticionPausada;
+    bool capturando; // Los frames van a un archivo: sin textos de la interfaz
+    efectoPendiente efectos[MAXIMO_EFECTOS_FRAME]; // Sonidos de los pasos de este frame
+    int cantidadEfectos;
 }; 
 
 
-// Funcin para inicializar SDL, ventana, renderizador y fuente
-bool inicializarJuego(pong& juego) {
+// Funcin para inicializar SDL, ventana, renderizador y fuente; fps <= 0 sincroniza con el monitor.
+// Para capturar la ventana queda oculta y sirve cualquier renderer, tambien el de software.
+// Con varias mesas la ventana se puede agrandar (o maximizar sobre varias pantallas) y se reparte entre ellas
+bool crearRecursos(recursosJuego& recursos, double fps, bool capturar, bool variasMesas) {
     
     // Inicia SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -78,15 +179,15 @@ bool inicializarJuego(pong& juego) {
     }
 
    // Crear ventana del juego
-    juego.ventana = SDL_CreateWindow(
+    recursos.ventana = SDL_CreateWindow(
         "Pong",
         SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED,
         ANCHO_VENTANA,
         ALTURA_VENTANA,
-        SDL_WINDOW_SHOWN
+        (capturar ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN) | (variasMesas ? SDL_WINDOW_RESIZABLE : 0)
     );
-    if (!juego.ventana) {
+    if (!recursos.ventana) {
         std::cerr << "Error creando ventana: " << SDL_GetError() << std::endl;
         TTF_Quit();
         SDL_Quit();
@@ -94,393 +195,1144 @@ bool inicializarJuego(pong& juego) {
     }
 
     // Renderizar el juego
-    juego.renderizar = SDL_CreateRenderer(juego.ventana, -1, SDL_RENDERER_ACCELERATED);
-    if (!juego.renderizar) {
+    Uint32 opciones = SDL_RENDERER_ACCELERATED | (fps > 0 ? 0 : SDL_RENDERER_PRESENTVSYNC);
+    if (capturar) opciones = SDL_RENDERER_TARGETTEXTURE;
+    recursos.renderizar = SDL_CreateRenderer(recursos.ventana, -1, opciones);
+    if (!recursos.renderizar) {
         std::cerr << "Error creando renderer: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(juego.ventana);
+        SDL_DestroyWindow(recursos.ventana);
         TTF_Quit();
         SDL_Quit();
         return false;
     }
 
-    // Fuente principal del juego
-    juego.fuente = TTF_OpenFont("assets/arial.ttf", 24);
-    if (!juego.fuente) {
-        std::cerr << "Error cargando fuente: " << TTF_GetError() << ". Asegurate de que arial.ttf este en la carpeta del ejecutable." << std::endl;
-        SDL_DestroyRenderer(juego.renderizar);
-        SDL_DestroyWindow(juego.ventana);
-        TTF_Quit();
-        SDL_Quit();
-        return false;
+    iniciarRitmo(recursos.ritmo, recursos.ventana, recursos.renderizar, fps);
+
+    // Recursos empaquetados, si el paquete no esta se usan los archivos de assets/
+    if (!abrirPaquete(RUTA_PAQUETE, recursos.paquete)) {
+        std::cerr << "No se encontro " << RUTA_PAQUETE << ", se cargan los archivos sueltos de assets/" << std::endl;
     }
-    // Inicializar SDL_mixer
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+
+    // Inicializar SDL_mixer antes de cargar sonidos, asi se convierten a su formato.
+    // Buffer chico: los efectos se programan con su muestra y la demora total es ADELANTO_EFECTOS
+    if (Mix_OpenAudio(FRECUENCIA_MEZCLADOR, MIX_DEFAULT_FORMAT, CANALES_MEZCLADOR, MUESTRAS_BUFFER_AUDIO) < 0) {
         std::cerr << "Error al inicializar SDL_mixer: " << Mix_GetError() << std::endl;
         return false;
     }
+    iniciarAudio(recursos.audio);
+
+    // Fuente, imagenes y sonidos se cargan en otros hilos; el menu se dibuja mientras tanto.
+    // Primero la fuente, que es lo que necesita el menu.
+    agregarFuente(recursos.cargador, "arial.ttf", 24, &recursos.atlas);
+    agregarTextura(recursos.cargador, "star-wars-fondo.bmp", &recursos.fondo);
+    agregarTextura(recursos.cargador, "sable-rojo.bmp", &recursos.sableIzquierdo);
+    agregarTextura(recursos.cargador, "sable-azul.bmp", &recursos.sableDerecho);
+    agregarSonido(recursos.cargador, "rebote_laser.wav", &recursos.sonidoRebote);
+    agregarSonido(recursos.cargador, "gol_grito.wav", &recursos.sonidoPunto);
+    agregarMusica(recursos.cargador, "musica_starwars_inspirada.wav", &recursos.musicaFondo);
+    iniciarCarga(recursos.cargador, recursos.paquete);
+
+    crearPerfil(recursos.perfil);
+    return true;
+}
+
+
+// Una partida nueva en el menu, con una referencia a los recursos compartidos
+void inicializarJuego(pong& juego, recursosJuego* recursos) {
+    juego.recursos = recursos;
+    recursos->referencias++;
+    juego.vista = { 0, 0, ANCHO_VENTANA, ALTURA_VENTANA };
+    juego.enFoco = true;
+    juego.teclasApretadas = 0;
+
+    crearCompositor(juego.capas, recursos->renderizar, ANCHO_VENTANA, ALTURA_VENTANA);
+    inicializarLote(juego.lote);
+
+    // Toda la memoria del modo caos se pide ahora, no durante la partida
+    crearCaos(juego.caos);
+    juego.dibujo.pelotas.resize(MAXIMO_PELOTAS_CAOS);
+    juego.dibujo.chispas.resize(MAXIMO_CHISPAS * 4);
+    juego.dibujo.indicesChispas.resize(MAXIMO_CHISPAS * 6);
+    for (int i = 0; i < MAXIMO_CHISPAS; i++) {
+        int* indice = &juego.dibujo.indicesChispas[i * 6];
+        indice[0] = i * 4; indice[1] = i * 4 + 1; indice[2] = i * 4 + 2;
+        indice[3] = i * 4; indice[4] = i * 4 + 2; indice[5] = i * 4 + 3;
+    }
 
+    // Inicializar paletas y pelota
+    inicializarSimulacion(juego.simulacion);
+    juego.simulacionAnterior = juego.simulacion;
+    juego.acumulador = 0;
 
-    juego.sonidoRebote = Mix_LoadWAV("assets/rebote_laser.wav");
-    juego.sonidoPunto = Mix_LoadWAV("assets/gol_grito.wav");
-    juego.musicaFondo = Mix_LoadMUS("assets/musica_starwars_inspirada.wav");
+    // Estado inicial
+    juego.estadoDeJuego = MENU;
+    juego.opcionSeleccionada = 0;
+    juego.dificultad = IA_NORMAL;
+    juego.reglas = REGLAS_CLASICAS;
+    juego.reglasPartida = REGLAS_CLASICAS;
+    juego.lastTime = SDL_GetPerformanceCounter();
+    juego.mensajeGanador = "";
+} 
 
 
+// Pone en los recursos compartidos lo que ya termino de cargarse; false si algo fallo
+bool actualizarCarga(recursosJuego& recursos) {
+    if (cargaTerminada(recursos.cargador)) return true;
+    if (!procesarCargas(recursos.cargador, recursos.renderizar)) return false;
 
-    if (!juego.sonidoRebote) {
-        std::cerr << "Error cargando rebote_laser.wav: " << Mix_GetError() << std::endl;
-    }
-    if (!juego.sonidoPunto) {
-        std::cerr << "Error cargando gol_grito.wav: " << Mix_GetError() << std::endl;
-    }
-    if (!juego.musicaFondo) {
-        std::cerr << "Error cargando musica_starwars_inspirada.wav: " << Mix_GetError() << std::endl;
+    // Los textos fijos se acomodan en cuanto llega el atlas
+    if (recursos.atlas.textura && !recursos.textosListos) {
+        for (int i = 0; i < TOTAL_TEXTOS; i++) {
+            recursos.textos[i] = prepararTexto(recursos.atlas, TEXTOS_DEL_JUEGO[i].texto, TEXTOS_DEL_JUEGO[i].x, TEXTOS_DEL_JUEGO[i].y);
+        }
+        recursos.textosListos = true;
     }
 
-    if (!juego.sonidoRebote || !juego.sonidoPunto || !juego.musicaFondo) return false;
-
-    // Cargar efectos de sonido y msica
-    
+    asignarSonido(recursos.audio, SONIDO_REBOTE, recursos.sonidoRebote);
+    asignarSonido(recursos.audio, SONIDO_PUNTO, recursos.sonidoPunto);
 
-
-   
-    SDL_Surface* fondoSurface = SDL_LoadBMP("assets/star-wars-fondo.bmp");
-    SDL_Surface* sableIzquierdoSurface = SDL_LoadBMP("assets/sable-rojo.bmp");
-    SDL_Surface* sableDerechoSurface = SDL_LoadBMP("assets/sable-azul.bmp");
-
-    if (!fondoSurface || !sableIzquierdoSurface || !sableDerechoSurface) {
-        std::cerr << "Error cargando imagenes: " << SDL_GetError() << std::endl;
-        return false;
+    // Reproducir msica de fondo en bucle
+    if (recursos.musicaFondo && !recursos.musicaIniciada) {
+        Mix_PlayMusic(recursos.musicaFondo, -1);
+        recursos.musicaIniciada = true;
+    }
+    return true;
+}
+
+
+// Barra de progreso abajo de la pantalla mientras se cargan los recursos
+void renderizarCarga(const pong& juego) {
+    const cargadorRecursos& cargador = juego.recursos->cargador;
+    if (cargaTerminada(cargador)) return;
+    SDL_Rect borde = { ANCHO_VENTANA / 4, ALTURA_VENTANA - 40, ANCHO_VENTANA / 2, 12 };
+    SDL_Rect barra = { borde.x + 2, borde.y + 2, (borde.w - 4) * cargador.terminados / cargador.cantidad, borde.h - 4 };
+    SDL_SetRenderDrawColor(juego.recursos->renderizar, 255, 255, 255, 255);
+    SDL_RenderDrawRect(juego.recursos->renderizar, &borde);
+    SDL_SetRenderDrawColor(juego.recursos->renderizar, 255, 220, 0, 255);
+    SDL_RenderFillRect(juego.recursos->renderizar, &barra);
+}
+
+
+// Panel de rendimiento arriba a la izquierda: FPS, p50/p99 y una barra por etapa
+void renderizarPerfil(pong& juego) {
+    const perfilFrames& perfil = juego.recursos->perfil;
+    if (!perfil.visible || !juego.enFoco) return;
+    const estadisticasPerfil& datos = perfil.estadisticas;
+    const int PIXELES_POR_MILISEGUNDO = 12;
+    const int ANCHO_PANEL = 520;
+    SDL_Color blanco = { 255, 255, 255, 255 };
+
+    SDL_Rect fondo = { 10, 10, ANCHO_PANEL, 160 + 30 * (TOTAL_ETAPAS - (juego.modoRed ? 0 : 1)) };
+    SDL_SetRenderDrawBlendMode(juego.recursos->renderizar, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(juego.recursos->renderizar, 0, 0, 0, 180);
+    SDL_RenderFillRect(juego.recursos->renderizar, &fondo);
+    SDL_SetRenderDrawBlendMode(juego.recursos->renderizar, SDL_BLENDMODE_NONE);
+
+    char linea[64];
+    snprintf(linea, sizeof(linea), "%.0f FPS  p50 %.2f ms  p99 %.2f ms", datos.fps, datos.p50, datos.p99);
+    renderizarTexto(juego.lote, juego.recursos->atlas, linea, 20, 20, blanco);
+    double latencia, latenciaMaxima;
+    resumirLatencia(juego.teclado, latencia, latenciaMaxima);
+    snprintf(linea, sizeof(linea), "entrada a pantalla %.1f ms  max %.1f ms", latencia, latenciaMaxima);
+    renderizarTexto(juego.lote, juego.recursos->atlas, linea, 20, 50, blanco);
+    resumenRitmo ritmo = resumirRitmo(juego.recursos->ritmo);
+    const char* modo = juego.recursos->ritmo.modo == RITMO_VSYNC ? "vsync" : "fijo";
+    snprintf(linea, sizeof(linea), "%s %.1f Hz  plazos perdidos %lld  peor %.1f ms", modo, ritmo.refrescoHz, ritmo.plazosPerdidos, ritmo.peorRetrasoMs);
+    renderizarTexto(juego.lote, juego.recursos->atlas, linea, 20, 80, blanco);
+    const motorAudio& audio = juego.recursos->audio;
+    snprintf(linea, sizeof(linea), "audio: tarde %u  robadas %u  unidos %u  perdidos %u",
+        audio.tarde.load(), audio.robadas.load(), audio.unidos.load(), audio.descartados.load());
+    renderizarTexto(juego.lote, juego.recursos->atlas, linea, 20, 110, blanco);
+
+    if (juego.modoRed) {
+        const sesionRed& red = juego.red;
+        snprintf(linea, sizeof(linea), "red: adelanto %d  rollbacks %d%s", red.paso - 1 - red.ultimoRemoto, red.rollbacks,
+            red.desincronizada ? "  DESINCRONIZADA" : "");
+        renderizarTexto(juego.lote, juego.recursos->atlas, linea, 20, 150 + 30 * (TOTAL_ETAPAS - 1), blanco);
     }
 
-    // Cargar imagenes y texturas
-    juego.fondo = SDL_CreateTextureFromSurface(juego.renderizar, fondoSurface);
-    juego.sableIzquierdo = SDL_CreateTextureFromSurface(juego.renderizar, sableIzquierdoSurface);
-    juego.sableDerecho = SDL_CreateTextureFromSurface(juego.renderizar, sableDerechoSurface);
+    // Una barra por etapa, la de texto esta dentro de la de renderizar
+    for (int etapa = ETAPA_EVENTOS; etapa < TOTAL_ETAPAS; etapa++) {
+        int y = 150 + 30 * (etapa - ETAPA_EVENTOS);
+        snprintf(linea, sizeof(linea), "%s %.2f", NOMBRES_ETAPAS[etapa], datos.promedio[etapa]);
+        renderizarTexto(juego.lote, juego.recursos->atlas, linea, 20, y, blanco);
+        int ancho = (int)(datos.promedio[etapa] * PIXELES_POR_MILISEGUNDO);
+        SDL_Rect barra = { 300, y + 6, ancho < ANCHO_PANEL - 300 ? ancho : ANCHO_PANEL - 300, 14 };
+        SDL_SetRenderDrawColor(juego.recursos->renderizar, 0, 200, 120, 255);
+        SDL_RenderFillRect(juego.recursos->renderizar, &barra);
+    }
+}
 
-    SDL_FreeSurface(fondoSurface);
-    SDL_FreeSurface(sableIzquierdoSurface);
-    SDL_FreeSurface(sableDerechoSurface);
 
-    // Reproducir msica de fondo en bucle
-    Mix_PlayMusic(juego.musicaFondo, -1);
+// Termina la partida en linea, si la habia, y avisa al otro jugador
+void terminarPartidaRed(pong& juego) {
+    if (!juego.modoRed && juego.red.estado == RED_DESCONECTADA) return;
+    cerrarRed(juego.red);
+    juego.modoRed = false;
+}
 
-    // Inicializar paletas
-    juego.paletaIzquierda = { 50, ALTURA_VENTANA / 2 - ALTURA_PALETA / 2, 0 };
-    juego.paletaDerecha = { ANCHO_VENTANA - 50 - ANCHO_PALETA, ALTURA_VENTANA / 2 - ALTURA_PALETA / 2, 0 };
 
-    // Inicializar pelota
-    juego.pelota = { ANCHO_VENTANA / 2, ALTURA_VENTANA / 2, VELOCIDAD_PELOTA, VELOCIDAD_PELOTA };
+// Graba la partida en repeticion-AAAAMMDD-HHMMSS.rep (con -2, -3 ... si ya existe); si no se puede, se juega igual sin grabar
+void empezarGrabacion(pong& juego) {
+    char nombre[64];
+    time_t ahora = time(nullptr);
+    strftime(nombre, sizeof(nombre), "repeticion-%Y%m%d-%H%M%S", localtime(&ahora));
+    iniciarGrabacion(juego.grabador, nombre, juego.reglasPartida);
+}
 
-    // Estado inicial
-    juego.estadoDeJuego = MENU;
-    juego.opcionSeleccionada = 0;
-    juego.juegoIniciado = true;
-    juego.lastTime = SDL_GetTicks();
-    juego.mensajeGanador = "";
 
-    return true;
-} 
+// Pasa a otra variante; las paletas vuelven a su lugar de salida porque la cancha puede cambiar
+void usarReglas(pong& juego, modoReglas reglas) {
+    if (juego.reglasPartida != reglas) REGISTRO_REGLAS[reglas].inicializar(juego.simulacion);
+    juego.reglasPartida = reglas;
+}
 
 
-// Funcin para renderizar texto  
-void renderizarTexto(SDL_Renderer* renderizador, TTF_Font* fuente, const std::string& texto, int x, int y, SDL_Color color) {   
-   
-    // Cargar fuentes
-    if (!fuente) {
-        std::cerr << "Error: Fuente no cargada para renderizar texto." << std::endl;
-        return;
-    } 
+// Cierra la grabacion con el estado despues del ultimo paso grabado
+void cerrarGrabacion(pong& juego) {
+    if (!juego.grabador.activo) return;
+    terminarGrabacion(juego.grabador, juego.modoRed ? estadoConfirmado(juego.red, juego.simulacion) : juego.simulacion);
+}
 
-    // Renderizar fuente
-    SDL_Surface* surface = TTF_RenderText_Solid(fuente, texto.c_str(), color);
-    if (!surface) {
-        std::cerr << "Error renderizando texto: " << TTF_GetError() << std::endl;
-        return;
-    }
-    
-    // Crea la textura del texto
-    SDL_Texture* textura = SDL_CreateTextureFromSurface(renderizador, surface);
-    if (!textura) {
-        std::cerr << "Error creando textura de texto: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(surface);
-        return;
-    }
 
+// Muestra el paso de la repeticion sin interpolar desde donde estaba
+void saltarRepeticion(pong& juego, int32_t paso) {
+    irAPaso(juego.repeticion, juego.reproductor, paso);
+    juego.simulacion = juego.simulacionAnterior = juego.reproductor.estado;
+    juego.acumulador = 0;
+}
 
-    SDL_Rect dst = { x, y, surface->w, surface->h };
-    SDL_RenderCopy(renderizador, textura, NULL, &dst);
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(textura);
-}   
 
+// Teclas de la repeticion: espacio pausa, flechas arriba y abajo cambian la velocidad, izquierda y derecha saltan
+void manejarTeclaRepeticion(pong& juego, SDL_Keycode tecla) {
+    if (tecla == SDLK_SPACE) juego.repeticionPausada = !juego.repeticionPausada;
+    else if (tecla == SDLK_UP && juego.velocidadRepeticion < VELOCIDAD_MAXIMA_REPETICION) juego.velocidadRepeticion *= 2;
+    else if (tecla == SDLK_DOWN && juego.velocidadRepeticion > 1) juego.velocidadRepeticion /= 2;
+    else if (tecla == SDLK_LEFT) saltarRepeticion(juego, juego.reproductor.paso - SALTO_REPETICION);
+    else if (tecla == SDLK_RIGHT) saltarRepeticion(juego, juego.reproductor.paso + SALTO_REPETICION);
+    else if (tecla == SDLK_HOME) saltarRepeticion(juego, 0);
+    else if (tecla == SDLK_ESCAPE) juego.estadoDeJuego = MENU;
+}
 
-// Funcin para manejar eventos
-void manejarEventos(pong& eventoJuego) {
-    SDL_Event evento;
-    while (SDL_PollEvent(&evento)) {
-        
-        // Sale del juego
-        if (evento.type == SDL_QUIT) {
-            eventoJuego.estadoDeJuego = SALIR;
-        }
 
-        // Abre el menu
-        else if (evento.type == SDL_KEYDOWN) {
-            if (eventoJuego.estadoDeJuego == MENU) {
-                if (evento.key.keysym.sym == SDLK_UP) {
-                    eventoJuego.opcionSeleccionada = (eventoJuego.opcionSeleccionada - 1 + 3) % 3;
-                }
-                else if (evento.key.keysym.sym == SDLK_DOWN) {
-                    eventoJuego.opcionSeleccionada = (eventoJuego.opcionSeleccionada + 1) % 3;
-                }
+// Funcin para manejar eventos: las teclas de la partida que tiene el foco
+void manejarTecla(pong& eventoJuego, const SDL_Event& evento) {
 
+    // Las teclas de las paletas se guardan con su hora para la simulacion
+    if (eventoJuego.estadoDeJuego == JUGANDO) {
+        registrarTecla(eventoJuego.teclado, evento.key);
+    }
 
-                else if (evento.key.keysym.sym == SDLK_RETURN) {
-                    if (eventoJuego.opcionSeleccionada == 0) {
-                        eventoJuego.estadoDeJuego = JUGANDO;
-                        // Reiniciar puntuaciones y pelota al iniciar el eventoJuego
-                        eventoJuego.paletaIzquierda.puntaje = 0;
-                        eventoJuego.paletaDerecha.puntaje = 0;
-                        eventoJuego.pelota.x = ANCHO_VENTANA / 2;
-                        eventoJuego.pelota.y = ALTURA_VENTANA / 2;
-                        eventoJuego.pelota.vx = VELOCIDAD_PELOTA;
-                        eventoJuego.pelota.vy = VELOCIDAD_PELOTA;
-                        eventoJuego.mensajeGanador = "";
-                    }
-                    else if (eventoJuego.opcionSeleccionada == 1) eventoJuego.estadoDeJuego = INSTRUCCIONES;
-                    else if (eventoJuego.opcionSeleccionada == 2) eventoJuego.estadoDeJuego = SALIR;
-                }
+    // Abre el menu
+    if (evento.type == SDL_KEYDOWN) {
+        if (eventoJuego.estadoDeJuego == MENU) {
+            if (evento.key.keysym.sym == SDLK_UP) {
+                eventoJuego.opcionSeleccionada = (eventoJuego.opcionSeleccionada - 1 + TOTAL_OPCIONES) % TOTAL_OPCIONES;
             }
-            else if (eventoJuego.estadoDeJuego == INSTRUCCIONES && evento.key.keysym.sym == SDLK_ESCAPE) {
-                eventoJuego.estadoDeJuego = MENU;
+            else if (evento.key.keysym.sym == SDLK_DOWN) {
+                eventoJuego.opcionSeleccionada = (eventoJuego.opcionSeleccionada + 1) % TOTAL_OPCIONES;
             }
-            else if (eventoJuego.estadoDeJuego == JUGANDO && evento.key.keysym.sym == SDLK_ESCAPE) {
-                eventoJuego.estadoDeJuego = MENU; // Volver al men desde el juego
+            else if (eventoJuego.opcionSeleccionada == OPCION_CONTRA_CPU && (evento.key.keysym.sym == SDLK_LEFT || evento.key.keysym.sym == SDLK_RIGHT)) {
+                int cambio = evento.key.keysym.sym == SDLK_LEFT ? TOTAL_NIVELES_IA - 1 : 1;
+                eventoJuego.dificultad = (nivelDificultad)((eventoJuego.dificultad + cambio) % TOTAL_NIVELES_IA);
             }
-            else if (eventoJuego.estadoDeJuego == GAME_OVER && evento.key.keysym.sym == SDLK_RETURN) {
-                eventoJuego.estadoDeJuego = MENU; // Volver al men desde pong Over
+            else if (eventoJuego.opcionSeleccionada == OPCION_JUGAR && (evento.key.keysym.sym == SDLK_LEFT || evento.key.keysym.sym == SDLK_RIGHT)) {
+                int cambio = evento.key.keysym.sym == SDLK_LEFT ? TOTAL_REGLAS - 1 : 1;
+                eventoJuego.reglas = (modoReglas)((eventoJuego.reglas + cambio) % TOTAL_REGLAS);
             }
+
+
+            else if (evento.key.keysym.sym == SDLK_RETURN) {
+                if (eventoJuego.opcionSeleccionada == OPCION_JUGAR || eventoJuego.opcionSeleccionada == OPCION_CONTRA_CPU || eventoJuego.opcionSeleccionada == OPCION_CAOS) {
+                    eventoJuego.estadoDeJuego = JUGANDO;
+                    // Reiniciar puntuaciones y pelota al iniciar el eventoJuego
+                    eventoJuego.modoCaos = eventoJuego.opcionSeleccionada == OPCION_CAOS;
+                    eventoJuego.contraCPU = eventoJuego.opcionSeleccionada == OPCION_CONTRA_CPU;
+                    reiniciarIA(eventoJuego.cpu, eventoJuego.dificultad, (uint32_t)SDL_GetPerformanceCounter());
+                    // El modo caos siempre es clasico; "Jugar" y "Contra la CPU" usan la variante elegida
+                    usarReglas(eventoJuego, eventoJuego.modoCaos ? REGLAS_CLASICAS : eventoJuego.reglas);
+                    if (eventoJuego.modoCaos) nuevaPartidaCaos(eventoJuego.simulacion, eventoJuego.caos);
+                    else REGISTRO_REGLAS[eventoJuego.reglasPartida].nuevaPartida(eventoJuego.simulacion);
+                    eventoJuego.simulacionAnterior = eventoJuego.simulacion;
+                    eventoJuego.acumulador = 0;
+                    eventoJuego.mensajeGanador = "";
+                    // El modo caos no se graba: su estado no entra en un cuadro clave
+                    if (!eventoJuego.modoCaos) empezarGrabacion(eventoJuego);
+                }
+                else if (eventoJuego.opcionSeleccionada == OPCION_INSTRUCCIONES) eventoJuego.estadoDeJuego = INSTRUCCIONES;
+                else if (eventoJuego.opcionSeleccionada == OPCION_SALIR) eventoJuego.estadoDeJuego = SALIR;
+            }
+        }
+        else if (eventoJuego.estadoDeJuego == INSTRUCCIONES && evento.key.keysym.sym == SDLK_ESCAPE) {
+            eventoJuego.estadoDeJuego = MENU;
+        }
+        else if (eventoJuego.estadoDeJuego == REPRODUCIENDO) {
+            manejarTeclaRepeticion(eventoJuego, evento.key.keysym.sym);
+        }
+        else if ((eventoJuego.estadoDeJuego == JUGANDO || eventoJuego.estadoDeJuego == ESPERANDO_RED) && evento.key.keysym.sym == SDLK_ESCAPE) {
+            eventoJuego.estadoDeJuego = MENU; // Volver al men desde el juego
+            cerrarGrabacion(eventoJuego);
+            terminarPartidaRed(eventoJuego);
+        }
+        else if (eventoJuego.estadoDeJuego == GAME_OVER && evento.key.keysym.sym == SDLK_RETURN) {
+            eventoJuego.estadoDeJuego = MENU; // Volver al men desde pong Over
+            terminarPartidaRed(eventoJuego);
         }
     }
 } 
 
 
-// Funcin para actualizar la lgica del juego
-void actualizarJuego(pong& actualizarJuego, float tiempoTranscurridoEntreFrames) {
-    if (actualizarJuego.estadoDeJuego != JUGANDO) return;
-
+// Teclas apretadas en este momento; se usa al empezar la partida, despues mandan los eventos con hora
+entradas leerEntradas() {
     const Uint8* estadoDelTeclado = SDL_GetKeyboardState(NULL);
-
-    // Mover paleta izquierda (W/S)
-    if (estadoDelTeclado[SDL_SCANCODE_W] && actualizarJuego.paletaIzquierda.y > 0) {
-        actualizarJuego.paletaIzquierda.y -= VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+    entradas teclas = 0;
+    if (estadoDelTeclado[SDL_SCANCODE_W]) teclas |= IZQUIERDA_ARRIBA;
+    if (estadoDelTeclado[SDL_SCANCODE_S]) teclas |= IZQUIERDA_ABAJO;
+    if (estadoDelTeclado[SDL_SCANCODE_A]) teclas |= IZQUIERDA_IZQUIERDA;
+    if (estadoDelTeclado[SDL_SCANCODE_D]) teclas |= IZQUIERDA_DERECHA;
+    if (estadoDelTeclado[SDL_SCANCODE_UP]) teclas |= DERECHA_ARRIBA;
+    if (estadoDelTeclado[SDL_SCANCODE_DOWN]) teclas |= DERECHA_ABAJO;
+    if (estadoDelTeclado[SDL_SCANCODE_LEFT]) teclas |= DERECHA_IZQUIERDA;
+    if (estadoDelTeclado[SDL_SCANCODE_RIGHT]) teclas |= DERECHA_DERECHA;
+    return teclas;
+}
+
+
+// Sonidos de lo que paso en un paso. momento: segundos del contador en que paso el rebote
+void sonarEventos(pong& juego, eventos ocurrido, double momento) {
+    if ((ocurrido & EVENTO_REBOTE) && juego.cantidadEfectos < MAXIMO_EFECTOS_FRAME) {
+        juego.efectos[juego.cantidadEfectos++] = { SONIDO_REBOTE, momento };
     }
-    if (estadoDelTeclado[SDL_SCANCODE_S] && actualizarJuego.paletaIzquierda.y < ALTURA_VENTANA - ALTURA_PALETA) {
-        actualizarJuego.paletaIzquierda.y += VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+    if ((ocurrido & (EVENTO_PUNTO_IZQUIERDA | EVENTO_PUNTO_DERECHA)) && juego.cantidadEfectos < MAXIMO_EFECTOS_FRAME) {
+        juego.efectos[juego.cantidadEfectos++] = { SONIDO_PUNTO, momento };
     }
-    
-    // Movimiento horizontal izquierda (A/D)
-    if (estadoDelTeclado[SDL_SCANCODE_A] && actualizarJuego.paletaIzquierda.x > 0) {
-        actualizarJuego.paletaIzquierda.x -= VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+}
+
+
+// Pasa al audio los sonidos del frame; solo desde el hilo principal
+void entregarEfectos(pong& juego) {
+    for (int i = 0; i < juego.cantidadEfectos; i++) {
+        tocarEfecto(juego.recursos->audio, juego.efectos[i].efecto, juego.efectos[i].momento);
+    }
+    juego.cantidadEfectos = 0;
+}
+
+
+// Espera al otro jugador; cuando aparece los dos empiezan la misma partida desde el paso 0
+void esperarRed(pong& juego) {
+    if (!conectarRed(juego.red)) return;
+    juego.modoRed = true;
+    juego.modoCaos = false;
+    juego.contraCPU = false;
+    usarReglas(juego, REGLAS_CLASICAS); // La red no manda las reglas: las dos maquinas juegan las clasicas
+    nuevaPartida(juego.simulacion);
+    juego.simulacionAnterior = juego.simulacion;
+    empezarPartidaRed(juego.red, juego.simulacion);
+    juego.mensajeGanador = "";
+    juego.acumulador = 0;
+    juego.estadoDeJuego = JUGANDO;
+    empezarGrabacion(juego);
+}
+
+
+// Pasos de la partida en linea: primero se corrige con lo que llego y despues se simula lo que falta
+void actualizarJuegoRed(pong& juego, double inicioPaso) {
+    sesionRed& red = juego.red;
+    recibirRed(red);
+    corregirRed(red, juego.simulacion);
+
+    // Si vamos adelantados se saltea un paso: el tiempo pasa pero las teclas quedan para el siguiente
+    bool espero = false;
+    while (juego.acumulador >= PASO_SIMULACION && red.estado == RED_CONECTADA) {
+        juego.acumulador -= PASO_SIMULACION;
+        if (!puedeAvanzarRed(red) || (!espero && convieneEsperarRed(red))) {
+            espero = true;
+            inicioPaso += PASO_SIMULACION;
+            continue;
+        }
+        entradasPaso teclas = consumirTeclado(juego.teclado, inicioPaso, inicioPaso + PASO_SIMULACION);
+        sonarEventos(juego, avanzarRed(red, juego.simulacion, entradaLocal(teclas)), inicioPaso);
+        inicioPaso += PASO_SIMULACION;
     }
-    if (estadoDelTeclado[SDL_SCANCODE_D] && actualizarJuego.paletaIzquierda.x < ANCHO_VENTANA / 2 - ANCHO_PALETA) {
-        actualizarJuego.paletaIzquierda.x += VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+    enviarEntradas(red);
+    juego.simulacionAnterior = red.paso > 0 ? red.estados[indiceRed(red.paso - 1)] : juego.simulacion;
+
+    // Se graban solo los pasos con las entradas reales de los dos, que ya no van a cambiar
+    int32_t confirmados = red.ultimoRemoto + 1 < red.paso ? red.ultimoRemoto + 1 : red.paso;
+    while (juego.grabador.activo && juego.grabador.paso < confirmados) {
+        int32_t paso = juego.grabador.paso;
+        grabarPaso(juego.grabador, red.estados[indiceRed(paso)], entradasConfirmadas(red, paso));
     }
 
-    // Mover paleta derecha (flechas arriba/abajo)
-    if (estadoDelTeclado[SDL_SCANCODE_UP] && actualizarJuego.paletaDerecha.y > 0) {
-        actualizarJuego.paletaDerecha.y -= VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+    // La partida termina cuando el ganador sale de entradas reales de los dos, no de una prediccion
+    const estadoSimulacion& confirmado = estadoConfirmado(red, juego.simulacion);
+    if (confirmado.ganador != NINGUNO) {
+        cerrarGrabacion(juego);
+        bool ganeYo = (confirmado.ganador == GANA_IZQUIERDA) == (red.lado == LADO_IZQUIERDO);
+        juego.simulacion = juego.simulacionAnterior = confirmado;
+        juego.estadoDeJuego = GAME_OVER;
+        juego.mensajeGanador = ganeYo ? "Ganaste!" : "Perdiste!";
+        juego.acumulador = 0;
     }
-    if (estadoDelTeclado[SDL_SCANCODE_DOWN] && actualizarJuego.paletaDerecha.y < ALTURA_VENTANA - ALTURA_PALETA) {
-        actualizarJuego.paletaDerecha.y += VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+    else if (redPerdida(red)) {
+        juego.estadoDeJuego = GAME_OVER;
+        juego.mensajeGanador = "Se perdio la conexion";
+        juego.acumulador = 0;
+        cerrarGrabacion(juego);
+        terminarPartidaRed(juego);
     }
-    
-    // Movimiento horizontal derecha (flechas izquierda/derecha)
-    if (estadoDelTeclado[SDL_SCANCODE_LEFT] && actualizarJuego.paletaDerecha.x > ANCHO_VENTANA / 2) {
-        actualizarJuego.paletaDerecha.x -= VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+}
+
+
+// La repeticion avanza velocidadRepeticion pasos por cada paso de tiempo real
+void actualizarRepeticion(pong& juego) {
+    if (juego.repeticionPausada) {
+        juego.acumulador = 0;
+        return;
     }
-    if (estadoDelTeclado[SDL_SCANCODE_RIGHT] && actualizarJuego.paletaDerecha.x < ANCHO_VENTANA - ANCHO_PALETA) {
-        actualizarJuego.paletaDerecha.x += VELOCIDAD_PALETA * tiempoTranscurridoEntreFrames;
+    double paso = PASO_SIMULACION / juego.velocidadRepeticion;
+    while (juego.acumulador >= paso) {
+        juego.acumulador -= paso;
+        juego.simulacionAnterior = juego.reproductor.estado;
+        if (!avanzarRepeticion(juego.repeticion, juego.reproductor)) {
+            juego.repeticionPausada = true;
+            juego.acumulador = 0;
+            break;
+        }
     }
+    juego.simulacion = juego.reproductor.estado;
+}
 
-    // Mover pelota
-    actualizarJuego.pelota.x += actualizarJuego.pelota.vx * tiempoTranscurridoEntreFrames;
-    actualizarJuego.pelota.y += actualizarJuego.pelota.vy * tiempoTranscurridoEntreFrames;
 
-    // Rebotar contra techo
-    if (actualizarJuego.pelota.y <= 0) {
-        actualizarJuego.pelota.y = 0;
-        actualizarJuego.pelota.vy = -actualizarJuego.pelota.vy;
-        Mix_PlayChannel(-1, actualizarJuego.sonidoRebote, 0);
+// Funcin para actualizar la lgica del juego, avanza en pasos fijos el tiempo acumulado
+void actualizarJuego(pong& actualizarJuego) {
+    tecladoConTiempo& teclado = actualizarJuego.teclado;
+    if (actualizarJuego.estadoDeJuego == ESPERANDO_RED) {
+        esperarRed(actualizarJuego);
+    }
+    if (actualizarJuego.estadoDeJuego == REPRODUCIENDO) {
+        actualizarRepeticion(actualizarJuego);
+        return;
     }
 
-    // Rebotar contra piso
-    else if (actualizarJuego.pelota.y >= ALTURA_VENTANA - TAMANIO_PELOTA) {
-        actualizarJuego.pelota.y = ALTURA_VENTANA - TAMANIO_PELOTA;
-        actualizarJuego.pelota.vy = -actualizarJuego.pelota.vy;
-        Mix_PlayChannel(-1, actualizarJuego.sonidoRebote, 0);
+    // Despues del final se sigue enviando hasta salir, por si al otro le faltan nuestras ultimas entradas
+    if (actualizarJuego.estadoDeJuego == GAME_OVER && actualizarJuego.modoRed) {
+        recibirRed(actualizarJuego.red);
+        enviarEntradas(actualizarJuego.red);
     }
 
-    // Colisin con paletas
-    SDL_Rect rectaDePelota = { (int)actualizarJuego.pelota.x, (int)actualizarJuego.pelota.y, TAMANIO_PELOTA, TAMANIO_PELOTA };
-    SDL_Rect rectaDePaletaIzquierda = { (int)actualizarJuego.paletaIzquierda.x, (int)actualizarJuego.paletaIzquierda.y, ANCHO_PALETA, ALTURA_PALETA };
-    SDL_Rect rectaDePaletaDerecha = { (int)actualizarJuego.paletaDerecha.x, (int)actualizarJuego.paletaDerecha.y, ANCHO_PALETA, ALTURA_PALETA };
+    if (actualizarJuego.estadoDeJuego != JUGANDO) {
+        actualizarJuego.acumulador = 0;
+        teclado.activo = false;
+        return;
+    }
 
-    if (SDL_HasIntersection(&rectaDePelota, &rectaDePaletaIzquierda)) {
-        actualizarJuego.pelota.x = actualizarJuego.paletaIzquierda.x + ANCHO_PALETA;
-        actualizarJuego.pelota.vx = -actualizarJuego.pelota.vx;
-        Mix_PlayChannel(-1, actualizarJuego.sonidoRebote, 0);
+    // Al empezar la partida se parte de las teclas que ya estan apretadas; sin el foco no hay ninguna
+    if (!teclado.activo) {
+        reiniciarTeclado(teclado, actualizarJuego.teclasApretadas);
+        teclado.activo = true;
     }
-    else if (SDL_HasIntersection(&rectaDePelota, &rectaDePaletaDerecha)) {
-        actualizarJuego.pelota.x = actualizarJuego.paletaDerecha.x - TAMANIO_PELOTA;
-        actualizarJuego.pelota.vx = -actualizarJuego.pelota.vx;
-        Mix_PlayChannel(-1, actualizarJuego.sonidoRebote, 0);
+
+    // El acumulador es el tiempo real que falta simular hasta el inicio de este frame:
+    // el primer paso empieza en ese instante y cada uno cubre PASO_SIMULACION de tiempo real
+    double inicioPaso = (double)actualizarJuego.lastTime / SDL_GetPerformanceFrequency() - actualizarJuego.acumulador;
+    if (actualizarJuego.modoRed) {
+        actualizarJuegoRed(actualizarJuego, inicioPaso);
+        return;
     }
 
-    // Puntuacin y reinicio de pelota
-    if (actualizarJuego.pelota.x + TAMANIO_PELOTA < 0) {
-        Mix_PlayChannel(-1, actualizarJuego.sonidoPunto, 0);
-        actualizarJuego.paletaDerecha.puntaje++;
-        actualizarJuego.pelota.x = ANCHO_VENTANA / 2;
-        actualizarJuego.pelota.y = ALTURA_VENTANA / 2;
-        actualizarJuego.pelota.vx = VELOCIDAD_PELOTA;
-        actualizarJuego.pelota.vy = VELOCIDAD_PELOTA;
+    while (actualizarJuego.acumulador >= PASO_SIMULACION) {
+        entradasPaso teclas = consumirTeclado(teclado, inicioPaso, inicioPaso + PASO_SIMULACION);
+        double momento = inicioPaso;
+        inicioPaso += PASO_SIMULACION;
+        if (actualizarJuego.contraCPU) teclasIA(actualizarJuego.cpu, actualizarJuego.simulacion, true, PASO_SIMULACION, teclas);
+        actualizarJuego.simulacionAnterior = actualizarJuego.simulacion;
+        if (!actualizarJuego.modoCaos) grabarPaso(actualizarJuego.grabador, actualizarJuego.simulacion, teclas);
+        // Fuera del modo caos el rebote suena en el momento exacto dentro del paso
+        float impacto = -1;
+        eventos ocurrido = actualizarJuego.modoCaos
+            ? avanzarCaos(actualizarJuego.simulacion, actualizarJuego.caos, teclas, PASO_SIMULACION)
+            : REGISTRO_REGLAS[actualizarJuego.reglasPartida].avanzar(actualizarJuego.simulacion, teclas, PASO_SIMULACION, &impacto);
+        actualizarJuego.acumulador -= PASO_SIMULACION;
+        sonarEventos(actualizarJuego, ocurrido, impacto >= 0 ? momento + impacto : momento);
+
+        // La pelota vuelve al centro, no se interpola desde el borde
+        if (ocurrido & (EVENTO_PUNTO_IZQUIERDA | EVENTO_PUNTO_DERECHA)) {
+            actualizarJuego.simulacionAnterior.pelota = actualizarJuego.simulacion.pelota;
+        }
 
-        if (actualizarJuego.paletaDerecha.puntaje >= PUNTAJE_GANADOR) {
+        if (ocurrido & EVENTO_FIN_PARTIDA) {
+            cerrarGrabacion(actualizarJuego);
             actualizarJuego.estadoDeJuego = GAME_OVER;
-            actualizarJuego.mensajeGanador = "Jugador Derecho Gana!";
+            bool ganaDerecha = actualizarJuego.simulacion.ganador == GANA_DERECHA;
+            if (actualizarJuego.contraCPU) actualizarJuego.mensajeGanador = ganaDerecha ? "Gana la CPU!" : "Ganaste!";
+            else actualizarJuego.mensajeGanador = ganaDerecha ? "Jugador Derecho Gana!" : "Jugador Izquierdo Gana!";
+            actualizarJuego.acumulador = 0;
+            break;
         }
     }
-   
-    // Todo lo relacionado al lado izquierdo
-    else if (actualizarJuego.pelota.x > ANCHO_VENTANA) {
-        Mix_PlayChannel(-1, actualizarJuego.sonidoPunto, 0);
-        actualizarJuego.paletaIzquierda.puntaje++;
-        std::cout << "Puntuacin: Izquierda " << actualizarJuego.paletaIzquierda.puntaje << " - Derecha " << actualizarJuego.paletaDerecha.puntaje << std::endl;
-        actualizarJuego.pelota.x = ANCHO_VENTANA / 2;
-        actualizarJuego.pelota.y = ALTURA_VENTANA / 2;
-        actualizarJuego.pelota.vx = -VELOCIDAD_PELOTA;
-        actualizarJuego.pelota.vy = VELOCIDAD_PELOTA;
-
-        if (actualizarJuego.paletaIzquierda.puntaje >= PUNTAJE_GANADOR) {
-            actualizarJuego.estadoDeJuego = GAME_OVER;
-            actualizarJuego.mensajeGanador = "Jugador Izquierdo Gana!";
-        }
-    }  
 } 
 
 
-// Funcin para renderizar el juego
-void renderizarJuego(const pong& renderizarJuego) {
-    // Dibujar fondo
-    SDL_RenderCopy(renderizarJuego.renderizar, renderizarJuego.fondo, NULL, NULL);
+// Dibuja un sable; mientras la imagen no llega se usa un rectangulo del mismo color
+void dibujarSable(SDL_Renderer* renderizador, SDL_Texture* textura, const SDL_Rect& rect, SDL_Color color) {
+    if (textura) {
+        SDL_RenderCopy(renderizador, textura, NULL, &rect);
+        return;
+    }
+    SDL_SetRenderDrawColor(renderizador, color.r, color.g, color.b, color.a);
+    SDL_RenderFillRect(renderizador, &rect);
+}
+
 
-    // Dibujar sable izquierdo
-    SDL_Rect rectIzq = { (int)renderizarJuego.paletaIzquierda.x, (int)renderizarJuego.paletaIzquierda.y, ANCHO_PALETA, ALTURA_PALETA };
-    SDL_RenderCopy(renderizarJuego.renderizar, renderizarJuego.sableIzquierdo, NULL, &rectIzq);
+// Dibuja todas las pelotas del modo caos con una llamada y todas las chispas con otra
+void renderizarCaos(pong& juego, float alfa) {
+    const poolPelotas& pelotas = juego.caos.pelotas;
+    SDL_FRect* rects = juego.dibujo.pelotas.data();
+    for (int i = 0; i < pelotas.cantidad; i++) {
+        rects[i] = { interpolar(pelotas.anteriorX[i], pelotas.x[i], alfa), interpolar(pelotas.anteriorY[i], pelotas.y[i], alfa), (float)TAMANIO_PELOTA, (float)TAMANIO_PELOTA };
+    }
+    SDL_SetRenderDrawColor(juego.recursos->renderizar, 255, 0, 0, 255);
+    SDL_RenderFillRectsF(juego.recursos->renderizar, rects, pelotas.cantidad);
+
+    // Chispas amarillas que se apagan con la vida que les queda
+    const poolChispas& chispas = juego.caos.chispas;
+    if (chispas.cantidad == 0) return;
+    SDL_Vertex* vertices = juego.dibujo.chispas.data();
+    SDL_FPoint sinTextura = { 0, 0 };
+    for (int i = 0; i < chispas.cantidad; i++) {
+        float x = chispas.x[i], y = chispas.y[i];
+        SDL_Color color = { 255, 220, 80, (Uint8)(255 * (chispas.vida[i] / VIDA_CHISPA)) };
+        vertices[i * 4 + 0] = { { x - 1.5f, y - 1.5f }, color, sinTextura };
+        vertices[i * 4 + 1] = { { x + 1.5f, y - 1.5f }, color, sinTextura };
+        vertices[i * 4 + 2] = { { x + 1.5f, y + 1.5f }, color, sinTextura };
+        vertices[i * 4 + 3] = { { x - 1.5f, y + 1.5f }, color, sinTextura };
+    }
+    SDL_SetRenderDrawBlendMode(juego.recursos->renderizar, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(juego.recursos->renderizar, NULL, vertices, chispas.cantidad * 4, juego.dibujo.indicesChispas.data(), chispas.cantidad * 6);
+    SDL_SetRenderDrawBlendMode(juego.recursos->renderizar, SDL_BLENDMODE_NONE);
+}
 
-    // Dibujar sable derecho
-    SDL_Rect rectDer = { (int)renderizarJuego.paletaDerecha.x, (int)renderizarJuego.paletaDerecha.y, ANCHO_PALETA, ALTURA_PALETA };
-    SDL_RenderCopy(renderizarJuego.renderizar, renderizarJuego.sableDerecho, NULL, &rectDer);
 
-    if (renderizarJuego.estadoDeJuego == MENU) {
+// Fondo de la pantalla (negro hasta que termine de cargarse)
+void dibujarFondo(pong& juego) {
+    if (juego.recursos->fondo) {
+        SDL_RenderCopy(juego.recursos->renderizar, juego.recursos->fondo, NULL, NULL);
+    }
+    else {
+        // SDL_RenderClear borraria toda la ventana, no solo la vista de esta partida
+        SDL_Rect cancha = { 0, 0, ANCHO_VENTANA, ALTURA_VENTANA };
+        SDL_SetRenderDrawColor(juego.recursos->renderizar, 0, 0, 0, 255);
+        SDL_RenderFillRect(juego.recursos->renderizar, &cancha);
+    }
+}
+
+
+// Lleva un rectangulo de la cancha a la ventana; una cancha mas grande que la ventana se achica y se centra
+SDL_Rect rectEnVentana(const pong& juego, float x, float y, float ancho, float alto) {
+    const juegoReglas& reglas = REGISTRO_REGLAS[juego.reglasPartida];
+    float escala = std::min(ANCHO_VENTANA / reglas.ancho, ALTURA_VENTANA / reglas.alto);
+    float origenX = (ANCHO_VENTANA - reglas.ancho * escala) / 2;
+    float origenY = (ALTURA_VENTANA - reglas.alto * escala) / 2;
+    return { (int)(origenX + x * escala), (int)(origenY + y * escala), (int)(ancho * escala), (int)(alto * escala) };
+}
+
+
+// Un sable entre su posicion del paso anterior y la del actual
+void dibujarSableInterpolado(pong& juego, SDL_Texture* textura, const paleta& anterior, const paleta& actual, float alfa, SDL_Color color) {
+    SDL_Rect rect = rectEnVentana(juego, interpolar(anterior.x, actual.x, alfa), interpolar(anterior.y, actual.y, alfa), ANCHO_PALETA, ALTURA_PALETA);
+    dibujarSable(juego.recursos->renderizar, textura, rect, color);
+}
+
+
+// Los sables entre el paso anterior y el actual; con cuatro paletas tambien las delanteras
+void dibujarSables(pong& juego, float alfa) {
+    const estadoSimulacion& anterior = juego.simulacionAnterior;
+    const estadoSimulacion& actual = juego.simulacion;
+    dibujarSableInterpolado(juego, juego.recursos->sableIzquierdo, anterior.paletaIzquierda, actual.paletaIzquierda, alfa, { 255, 0, 0, 255 });
+    dibujarSableInterpolado(juego, juego.recursos->sableDerecho, anterior.paletaDerecha, actual.paletaDerecha, alfa, { 0, 120, 255, 255 });
+
+    const juegoReglas& reglas = REGISTRO_REGLAS[juego.reglasPartida];
+    if (!reglas.delanteras) return;
+    paleta izquierdaAnterior, derechaAnterior, izquierda, derecha;
+    reglas.delanteras(anterior, izquierdaAnterior, derechaAnterior);
+    reglas.delanteras(actual, izquierda, derecha);
+    dibujarSableInterpolado(juego, juego.recursos->sableIzquierdo, izquierdaAnterior, izquierda, alfa, { 255, 0, 0, 255 });
+    dibujarSableInterpolado(juego, juego.recursos->sableDerecho, derechaAnterior, derecha, alfa, { 0, 120, 255, 255 });
+}
+
+
+// Textos de las pantallas sin partida
+void dibujarTextosPantalla(pong& juego) {
+    if (juego.estadoDeJuego == MENU) {
         SDL_Color color = { 255, 255, 255, 255 }; // Blanco
         SDL_Color selectedColor = { 255, 255, 0, 255 }; // Amarillo
 
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Pong", ANCHO_VENTANA / 2 - 50, 100, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Jugar", ANCHO_VENTANA / 2 - 50, 200, renderizarJuego.opcionSeleccionada == 0 ? selectedColor : color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Instrucciones", ANCHO_VENTANA / 2 - 50, 250, renderizarJuego.opcionSeleccionada == 1 ? selectedColor : color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Salir", ANCHO_VENTANA / 2 - 50, 300, renderizarJuego.opcionSeleccionada == 2 ? selectedColor : color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_TITULO], color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_JUGAR], juego.opcionSeleccionada == OPCION_JUGAR ? selectedColor : color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_CONTRA_CPU], juego.opcionSeleccionada == OPCION_CONTRA_CPU ? selectedColor : color);
+        if (juego.opcionSeleccionada == OPCION_CONTRA_CPU) {
+            char textoDificultad[32];
+            snprintf(textoDificultad, sizeof(textoDificultad), "< %s >", DIFICULTADES_IA[juego.dificultad].nombre);
+            renderizarTexto(juego.lote, juego.recursos->atlas, textoDificultad, ANCHO_VENTANA / 2 + 150, TEXTOS_DEL_JUEGO[TEXTO_CONTRA_CPU].y, selectedColor);
+        }
+        if (juego.opcionSeleccionada == OPCION_JUGAR) {
+            char textoReglas[32];
+            snprintf(textoReglas, sizeof(textoReglas), "< %s >", REGISTRO_REGLAS[juego.reglas].nombre);
+            renderizarTexto(juego.lote, juego.recursos->atlas, textoReglas, ANCHO_VENTANA / 2 + 150, TEXTOS_DEL_JUEGO[TEXTO_JUGAR].y, selectedColor);
+        }
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_CAOS], juego.opcionSeleccionada == OPCION_CAOS ? selectedColor : color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_INSTRUCCIONES], juego.opcionSeleccionada == OPCION_INSTRUCCIONES ? selectedColor : color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_SALIR], juego.opcionSeleccionada == OPCION_SALIR ? selectedColor : color);
     }
    
     // Fue seleccionada la opcion INSTRUCCIONES
-    else if (renderizarJuego.estadoDeJuego == INSTRUCCIONES) {
+    else if (juego.estadoDeJuego == INSTRUCCIONES) {
         SDL_Color color = { 255, 255, 255, 255 };
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Instrucciones", ANCHO_VENTANA / 2 - 80, 100, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Jugador Izquierdo:", ANCHO_VENTANA / 2 - 80, 200, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "W: Subir", ANCHO_VENTANA / 2 - 80, 230, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "S: Bajar", ANCHO_VENTANA / 2 - 80, 260, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Jugador Derecho:", ANCHO_VENTANA / 2 - 80, 300, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Flecha Arriba: Subir", ANCHO_VENTANA / 2 - 80, 330, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Flecha Abajo: Bajar", ANCHO_VENTANA / 2 - 80, 360, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Presiona ESC para volver", ANCHO_VENTANA / 2 - 80, 450, color);
+        for (int i = TEXTO_TITULO_INSTRUCCIONES; i <= TEXTO_VOLVER_ESC; i++) {
+            renderizarTexto(juego.lote, juego.recursos->textos[i], color);
+        }
     }
     
-    // Fue seleccionada la opcion JUGAR
-    else if (renderizarJuego.estadoDeJuego == JUGANDO) {
-        SDL_SetRenderDrawColor(renderizarJuego.renderizar, 255, 0, 0, 255); // Objetos blancos
-
-        // Dibujar pelota
-        SDL_Rect ballDraw = { (int)renderizarJuego.pelota.x, (int)renderizarJuego.pelota.y, TAMANIO_PELOTA, TAMANIO_PELOTA };
-        SDL_RenderFillRect(renderizarJuego.renderizar, &ballDraw);
-
-        // Mostrar puntuacin
-        std::string textoDelPuntaje = std::to_string(renderizarJuego.paletaIzquierda.puntaje) + " - " + std::to_string(renderizarJuego.paletaDerecha.puntaje);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, textoDelPuntaje, ANCHO_VENTANA / 2 - 20, 20, { 255, 255, 255, 255 });
+    // Partida en linea esperando al otro jugador
+    else if (juego.estadoDeJuego == ESPERANDO_RED) {
+        SDL_Color color = { 255, 255, 255, 255 };
+        const char* mensaje = juego.red.servidor ? "Esperando al otro jugador..." : "Conectando...";
+        renderizarTexto(juego.lote, juego.recursos->atlas, mensaje, ANCHO_VENTANA / 2 - 150, ALTURA_VENTANA / 2 - 50, color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_VOLVER_ESC], color);
     }
-    
+
     // Se cerro el juego, sea por la opcion salir y/o gano un jugador
-    else if (renderizarJuego.estadoDeJuego == GAME_OVER) {
+    else if (juego.estadoDeJuego == GAME_OVER) {
         SDL_Color color = { 255, 255, 255, 255 };
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, renderizarJuego.mensajeGanador, ANCHO_VENTANA / 2 - 100, ALTURA_VENTANA / 2 - 50, color);
-        renderizarTexto(renderizarJuego.renderizar, renderizarJuego.fuente, "Presiona ENTER para volver al men", ANCHO_VENTANA / 2 - 100, ALTURA_VENTANA / 2 + 50, color);
+        renderizarTexto(juego.lote, juego.recursos->atlas, juego.mensajeGanador, ANCHO_VENTANA / 2 - 100, ALTURA_VENTANA / 2 - 50, color);
+        renderizarTexto(juego.lote, juego.recursos->textos[TEXTO_VOLVER_MENU], color);
+    }
+}
+
+
+void dibujarPuntaje(pong& juego) {
+    char textoDelPuntaje[32];
+    snprintf(textoDelPuntaje, sizeof(textoDelPuntaje), "%d - %d", juego.simulacion.paletaIzquierda.puntaje, juego.simulacion.paletaDerecha.puntaje);
+    renderizarTexto(juego.lote, juego.recursos->atlas, textoDelPuntaje, ANCHO_VENTANA / 2 - 20, 20, { 255, 255, 255, 255 });
+}
+
+
+// Pantallas que solo cambian con una tecla o cuando llega un recurso
+inline bool pantallaQuieta(const pong& juego) {
+    return juego.estadoDeJuego == MENU || juego.estadoDeJuego == INSTRUCCIONES || juego.estadoDeJuego == ESPERANDO_RED || juego.estadoDeJuego == GAME_OVER;
+}
+
+
+// Todo lo que se ve en una pantalla quieta
+uint64_t claveEscena(const pong& juego) {
+    uint64_t clave = mezclarClave(0, juego.estadoDeJuego);
+    clave = mezclarClave(clave, (uint64_t)juego.opcionSeleccionada);
+    clave = mezclarClave(clave, (uint64_t)juego.dificultad);
+    clave = mezclarClave(clave, (uint64_t)juego.reglas);
+    clave = mezclarClave(clave, (uint64_t)juego.reglasPartida);
+    clave = mezclarClave(clave, (uintptr_t)juego.mensajeGanador);
+    clave = mezclarClave(clave, juego.red.servidor);
+    clave = mezclarClave(clave, (uintptr_t)juego.recursos->fondo);
+    clave = mezclarClave(clave, (uintptr_t)juego.recursos->sableIzquierdo);
+    clave = mezclarClave(clave, (uintptr_t)juego.recursos->sableDerecho);
+    clave = mezclarClave(clave, juego.recursos->textosListos);
+    for (const estadoSimulacion* estado : { &juego.simulacionAnterior, &juego.simulacion }) {
+        uint32_t campos[CAMPOS_ESTADO];
+        camposEstado(*estado, campos);
+        for (int i = 0; i < 4; i++) clave = mezclarClave(clave, campos[i]); // Posiciones de las paletas
+    }
+    return clave;
+}
+
+
+// Fondo y puntaje de la partida: cambian con cada punto
+uint64_t claveFondoPartida(const pong& juego) {
+    uint64_t clave = mezclarClave(0, (uintptr_t)juego.recursos->fondo);
+    clave = mezclarClave(clave, juego.recursos->textosListos);
+    clave = mezclarClave(clave, (uint64_t)juego.simulacion.paletaIzquierda.puntaje);
+    return mezclarClave(clave, (uint64_t)juego.simulacion.paletaDerecha.puntaje);
+}
+
+
+// La pantalla quieta ya presentada sigue igual: no hace falta dibujarla de nuevo
+bool escenaSinCambios(const pong& juego, uint64_t clave) {
+    const compositorCapas& capas = juego.capas;
+    return capas.presentada && capas.clavePresentada == clave && !juego.recursos->perfil.visible && cargaTerminada(juego.recursos->cargador);
+}
+
+
+// Una pantalla quieta sale de su capa; si es igual a la que ya esta en pantalla no hace falta dibujar nada
+bool renderizarEscenaQuieta(pong& juego, float alfa) {
+    compositorCapas& capas = juego.capas;
+    uint64_t clave = claveEscena(juego);
+    if (escenaSinCambios(juego, clave)) return false;
+
+    if (empezarCapa(juego.recursos->renderizar, capas.escena, clave)) {
+        dibujarFondo(juego);
+        dibujarSables(juego, alfa);
+        dibujarTextosPantalla(juego);
+        dibujarLoteTexto(juego.recursos->renderizar, juego.recursos->atlas, juego.lote);
+        terminarCapa(juego.recursos->renderizar, capas);
+    }
+    mostrarCapa(juego.recursos->renderizar, capas.escena);
+    capas.clavePresentada = clave;
+    capas.presentada = true;
+    return true;
+}
+
+
+// Funcin para renderizar el juego; devuelve false si el frame seria igual al que ya se mostro
+bool renderizarJuego(pong& renderizarJuego, float alfa) {
+    compositorCapas& capas = renderizarJuego.capas;
+    bool enPartida = renderizarJuego.estadoDeJuego == JUGANDO || renderizarJuego.estadoDeJuego == REPRODUCIENDO;
+
+    if (capas.disponible && pantallaQuieta(renderizarJuego)) {
+        if (!renderizarEscenaQuieta(renderizarJuego, alfa)) return false;
+    }
+    else if (capas.disponible && enPartida) {
+        if (empezarCapa(renderizarJuego.recursos->renderizar, capas.fondoPartida, claveFondoPartida(renderizarJuego))) {
+            dibujarFondo(renderizarJuego);
+            dibujarPuntaje(renderizarJuego);
+            dibujarLoteTexto(renderizarJuego.recursos->renderizar, renderizarJuego.recursos->atlas, renderizarJuego.lote);
+            terminarCapa(renderizarJuego.recursos->renderizar, capas);
+        }
+        mostrarCapa(renderizarJuego.recursos->renderizar, capas.fondoPartida);
+        dibujarSables(renderizarJuego, alfa);
+        capas.presentada = false;
+    }
+    else {
+        dibujarFondo(renderizarJuego);
+        dibujarSables(renderizarJuego, alfa);
+        if (enPartida) dibujarPuntaje(renderizarJuego);
+        else dibujarTextosPantalla(renderizarJuego);
+    }
+
+    // Fue seleccionada la opcion JUGAR, o se mira una repeticion
+    if (enPartida) {
+        const estadoSimulacion& anterior = renderizarJuego.simulacionAnterior;
+        const estadoSimulacion& actual = renderizarJuego.simulacion;
+        // Una cancha achicada no llena la ventana: se marcan sus bordes
+        const juegoReglas& reglas = REGISTRO_REGLAS[renderizarJuego.reglasPartida];
+        if (reglas.ancho != ANCHO_VENTANA || reglas.alto != ALTURA_VENTANA) {
+            SDL_Rect borde = rectEnVentana(renderizarJuego, 0, 0, reglas.ancho, reglas.alto);
+            SDL_SetRenderDrawColor(renderizarJuego.recursos->renderizar, 255, 255, 255, 255);
+            SDL_RenderDrawRect(renderizarJuego.recursos->renderizar, &borde);
+        }
+        SDL_SetRenderDrawColor(renderizarJuego.recursos->renderizar, 255, 0, 0, 255); // Objetos blancos
+
+        // Dibujar pelota, o todas las del modo caos
+        if (renderizarJuego.modoCaos) {
+            renderizarCaos(renderizarJuego, alfa);
+        }
+        else {
+            SDL_Rect ballDraw = rectEnVentana(renderizarJuego, interpolar(anterior.pelota.x, actual.pelota.x, alfa), interpolar(anterior.pelota.y, actual.pelota.y, alfa), TAMANIO_PELOTA, TAMANIO_PELOTA);
+            SDL_RenderFillRect(renderizarJuego.recursos->renderizar, &ballDraw);
+        }
+
+        // Posicion y velocidad de la repeticion
+        if (renderizarJuego.estadoDeJuego == REPRODUCIENDO && !renderizarJuego.capturando) {
+            int segundo = renderizarJuego.reproductor.paso / PASOS_POR_CLAVE;
+            int total = renderizarJuego.repeticion.totalPasos / PASOS_POR_CLAVE;
+            char textoRepeticion[64];
+            snprintf(textoRepeticion, sizeof(textoRepeticion), "Repeticion %dx  %d:%02d / %d:%02d%s", renderizarJuego.velocidadRepeticion,
+                segundo / 60, segundo % 60, total / 60, total % 60, renderizarJuego.repeticionPausada ? "  (pausa)" : "");
+            renderizarTexto(renderizarJuego.lote, renderizarJuego.recursos->atlas, textoRepeticion, 20, ALTURA_VENTANA - 40, { 255, 255, 255, 255 });
+        }
     }
 
-    SDL_RenderPresent(renderizarJuego.renderizar);
+    renderizarPerfil(renderizarJuego);
+
+    // Todo el texto del frame en una sola llamada
+    {
+        temporizadorPerfil medir(renderizarJuego.recursos->perfil, ETAPA_TEXTO);
+        dibujarLoteTexto(renderizarJuego.recursos->renderizar, renderizarJuego.recursos->atlas, renderizarJuego.lote);
+    }
+    renderizarCarga(renderizarJuego);
+    return true;
 } 
 
 
-// Funcin para limpiar recursos
-void limpiarJuego(pong& limpiarJuego) {
-    if (limpiarJuego.fuente) TTF_CloseFont(limpiarJuego.fuente);
-    if (limpiarJuego.renderizar) SDL_DestroyRenderer(limpiarJuego.renderizar);
-    if (limpiarJuego.ventana) SDL_DestroyWindow(limpiarJuego.ventana);
-    if (limpiarJuego.fondo) SDL_DestroyTexture(limpiarJuego.fondo);
-    if (limpiarJuego.sableIzquierdo) SDL_DestroyTexture(limpiarJuego.sableIzquierdo);
-    if (limpiarJuego.sableDerecho) SDL_DestroyTexture(limpiarJuego.sableDerecho);
-    if (limpiarJuego.sonidoRebote) Mix_FreeChunk(limpiarJuego.sonidoRebote);
-    if (limpiarJuego.sonidoPunto) Mix_FreeChunk(limpiarJuego.sonidoPunto);
-    if (limpiarJuego.musicaFondo) Mix_FreeMusic(limpiarJuego.musicaFondo);
+// Captura la repeticion abierta a un archivo: cada frame avanza 1/fps segundos de partida, sin esperar
+// a nada, asi la captura sale siempre igual y va tan rapido como se pueda dibujar y escribir
+int capturarRepeticion(pong& juego, const char* ruta, double fps) {
+    capturaFrames captura;
+    if (!iniciarCaptura(captura, juego.recursos->renderizar, ruta, ANCHO_VENTANA, ALTURA_VENTANA, fps)) return 1;
+    juego.capas.destino = captura.destino;
+    juego.capturando = true;
+    invalidarCapas(juego.capas);
+
+    // Todos los recursos antes del primer frame
+    while (!cargaTerminada(juego.recursos->cargador) && juego.estadoDeJuego != SALIR) {
+        if (!actualizarCarga(*juego.recursos)) juego.estadoDeJuego = SALIR;
+        SDL_Delay(1);
+    }
+
+    double periodo = 1.0 / captura.fps;
+    long long cada = std::max(1LL, (long long)(captura.fps * 10));
+    while (juego.estadoDeJuego == REPRODUCIENDO) {
+        SDL_Event evento;
+        while (SDL_PollEvent(&evento)) {
+            if (evento.type == SDL_QUIT) juego.estadoDeJuego = SALIR;
+            else if (evento.type == SDL_RENDER_TARGETS_RESET || evento.type == SDL_RENDER_DEVICE_RESET) invalidarCapas(juego.capas);
+        }
+
+        juego.acumulador += periodo;
+        actualizarRepeticion(juego);
+        SDL_SetRenderTarget(juego.recursos->renderizar, captura.destino);
+        renderizarJuego(juego, (float)(juego.acumulador / PASO_SIMULACION));
+        capturarFrame(captura, juego.recursos->renderizar);
+
+        if (captura.capturados % cada == 0) printf("%s: %lld frames, paso %d de %d\n", ruta, captura.capturados, juego.reproductor.paso, juego.repeticion.totalPasos);
+        if (juego.repeticionPausada) break; // Ultimo frame: la repeticion termino
+    }
+    SDL_SetRenderTarget(juego.recursos->renderizar, NULL);
+    juego.capas.destino = nullptr;
+
+    resumenCaptura resumen = terminarCaptura(captura);
+    printf("%s: %lld frames a %g FPS en %.2f s (%.1f frames/s, %.1fx tiempo real), %lld descartados, %lld esperas al escritor\n",
+        ruta, resumen.frames, captura.fps, resumen.segundos, resumen.framesPorSegundo, resumen.vecesTiempoReal, resumen.descartados, resumen.esperas);
+    return resumen.descartados == 0 && juego.estadoDeJuego != SALIR ? 0 : 1;
+}
+
+
+// Suelta una referencia a los recursos; el ultimo que suelta libera todo y cierra SDL
+void soltarRecursos(recursosJuego* recursos) {
+    if (--recursos->referencias > 0) return;
+    escribirTraza(recursos->perfil, RUTA_TRAZA);
+    terminarCarga(recursos->cargador);
+    destruirAtlasTexto(recursos->atlas);
+    if (recursos->fondo) SDL_DestroyTexture(recursos->fondo);
+    if (recursos->sableIzquierdo) SDL_DestroyTexture(recursos->sableIzquierdo);
+    if (recursos->sableDerecho) SDL_DestroyTexture(recursos->sableDerecho);
+    if (recursos->renderizar) SDL_DestroyRenderer(recursos->renderizar);
+    if (recursos->ventana) SDL_DestroyWindow(recursos->ventana);
+    cerrarAudio(recursos->audio);
+    if (recursos->sonidoRebote) Mix_FreeChunk(recursos->sonidoRebote);
+    if (recursos->sonidoPunto) Mix_FreeChunk(recursos->sonidoPunto);
+    if (recursos->musicaFondo) Mix_FreeMusic(recursos->musicaFondo);
     Mix_CloseAudio();
+    cerrarPaquete(recursos->paquete);
     Mix_Quit();
     TTF_Quit();
     SDL_Quit();
+    delete recursos;
+}
+
+
+// Funcin para limpiar recursos: los de la partida, y suelta su referencia a los compartidos
+void limpiarJuego(pong& limpiarJuego) {
+    cerrarGrabacion(limpiarJuego);
+    terminarPartidaRed(limpiarJuego);
+    destruirCompositor(limpiarJuego.capas);
+    soltarRecursos(limpiarJuego.recursos);
+    limpiarJuego.recursos = nullptr;
 } 
 
 
-//Funcion principal para que funcione el juego, el cuerpo de todo el programa
-int main(int argc, char* argv[]) {
-    pong juegoFinal = {};
+// Varias partidas en una ventana, cada una en su vista. Las simulaciones corren en paralelo en el pool;
+// eventos, audio y dibujo quedan en el hilo principal, que es donde SDL deja usarlos
+struct salaArcade {
+    recursosJuego* recursos = nullptr; // La sala tambien tiene una referencia mientras corre
+    std::vector<pong*> partidas;
+    poolTareas pool;
+    int foco = 0; // Partida que recibe el teclado
+};
+
+
+// Reparte la ventana en una grilla, una vista por partida con la proporcion de la cancha
+void acomodarVistas(salaArcade& sala) {
+    int ancho, alto;
+    SDL_GetRendererOutputSize(sala.recursos->renderizar, &ancho, &alto);
+    int cantidad = (int)sala.partidas.size();
+    int columnas = 1;
+    while (columnas * columnas < cantidad) columnas++;
+    int filas = (cantidad + columnas - 1) / columnas;
+    float escala = std::min((float)ancho / columnas / ANCHO_VENTANA, (float)alto / filas / ALTURA_VENTANA);
+    int anchoVista = (int)(ANCHO_VENTANA * escala), altoVista = (int)(ALTURA_VENTANA * escala);
+    for (int i = 0; i < cantidad; i++) {
+        int celdaX = i % columnas * ancho / columnas, celdaY = i / columnas * alto / filas;
+        sala.partidas[i]->vista = { celdaX + (ancho / columnas - anchoVista) / 2, celdaY + (alto / filas - altoVista) / 2, anchoVista, altoVista };
+    }
+}
+
+
+// Deja el renderer dibujando en la vista de la partida con las coordenadas de siempre (ANCHO_VENTANA x ALTURA_VENTANA).
+// SDL escala tambien el rectangulo de la vista, por eso se divide por la escala
+void usarVista(const pong& juego) {
+    float escala = (float)juego.vista.w / ANCHO_VENTANA;
+    SDL_Rect vista = { (int)(juego.vista.x / escala), (int)(juego.vista.y / escala), ANCHO_VENTANA, ALTURA_VENTANA };
+    SDL_RenderSetScale(juego.recursos->renderizar, escala, escala);
+    SDL_RenderSetViewport(juego.recursos->renderizar, &vista);
+}
+
+
+// Pasa el teclado a otra partida; todas sueltan las teclas que tenian y se vuelven a dibujar
+void enfocar(salaArcade& sala, int foco) {
+    sala.foco = foco;
+    for (int i = 0; i < (int)sala.partidas.size(); i++) {
+        pong& juego = *sala.partidas[i];
+        juego.enFoco = i == foco;
+        juego.teclado.activo = false;
+        juego.capas.presentada = false;
+    }
+}
+
+
+// Eventos de la ventana: los generales para todas las partidas, las teclas para la que tiene el foco.
+// Con varias mesas Tab o un click sobre una vista cambian el foco
+void manejarEventos(salaArcade& sala) {
+    bool variasMesas = sala.partidas.size() > 1;
+    SDL_Event evento;
+    while (SDL_PollEvent(&evento)) {
+
+        // Sale del juego
+        if (evento.type == SDL_QUIT) {
+            for (pong* juego : sala.partidas) juego->estadoDeJuego = SALIR;
+        }
+
+        // La ventana se tapo, cambio de tamao o el driver perdio las texturas destino: hay que volver a dibujar todo
+        else if (evento.type == SDL_WINDOWEVENT || evento.type == SDL_RENDER_TARGETS_RESET || evento.type == SDL_RENDER_DEVICE_RESET) {
+            for (pong* juego : sala.partidas) invalidarCapas(juego->capas);
+        }
+
+        // Panel de rendimiento, en cualquier pantalla
+        else if (evento.type == SDL_KEYDOWN && evento.key.keysym.sym == SDLK_F3) {
+            sala.recursos->perfil.visible = !sala.recursos->perfil.visible;
+            sala.recursos->perfil.ultimoCalculo = 0;
+        }
+
+        else if (variasMesas && evento.type == SDL_KEYDOWN && evento.key.keysym.sym == SDLK_TAB) {
+            enfocar(sala, (sala.foco + 1) % (int)sala.partidas.size());
+        }
+        else if (variasMesas && evento.type == SDL_MOUSEBUTTONDOWN) {
+            SDL_Point punto = { evento.button.x, evento.button.y };
+            for (int i = 0; i < (int)sala.partidas.size(); i++) {
+                if (SDL_PointInRect(&punto, &sala.partidas[i]->vista)) enfocar(sala, i);
+            }
+        }
+        else if (evento.type == SDL_KEYDOWN || evento.type == SDL_KEYUP) {
+            manejarTecla(*sala.partidas[sala.foco], evento);
+        }
+    }
+
+    // SDL_GetKeyboardState es del hilo principal: las partidas, que se simulan en el pool, usan esta copia
+    entradas apretadas = leerEntradas();
+    for (pong* juego : sala.partidas) juego->teclasApretadas = juego->enFoco ? apretadas : 0;
+}
+
+
+// Tarea del pool: los pasos de una partida en este frame
+void actualizarPartida(void* datos) {
+    actualizarJuego(*(pong*)datos);
+}
+
+
+// Todas las partidas en sus vistas; false si ninguna cambio y lo que esta en pantalla sigue valiendo.
+// Si una cambia se dibujan todas, porque despues de presentar el resto de la ventana no se conserva
+bool renderizarSala(salaArcade& sala) {
+    bool sinCambios = true;
+    for (pong* juego : sala.partidas) {
+        sinCambios = sinCambios && juego->capas.disponible && pantallaQuieta(*juego) && escenaSinCambios(*juego, claveEscena(*juego));
+    }
+    if (sinCambios) return false;
+
+    SDL_Renderer* renderizador = sala.recursos->renderizar;
+    bool variasMesas = sala.partidas.size() > 1;
+    if (variasMesas) {
+        acomodarVistas(sala);
+        SDL_SetRenderDrawColor(renderizador, 0, 0, 0, 255);
+        SDL_RenderClear(renderizador);
+    }
+    for (pong* juego : sala.partidas) {
+        juego->capas.presentada = false;
+        usarVista(*juego);
+        renderizarJuego(*juego, (float)(juego->acumulador / PASO_SIMULACION));
+    }
+    SDL_RenderSetScale(renderizador, 1, 1);
+    SDL_RenderSetViewport(renderizador, NULL);
+
+    // Borde de la partida que tiene el teclado
+    if (variasMesas) {
+        SDL_SetRenderDrawColor(renderizador, 255, 255, 0, 255);
+        SDL_RenderDrawRect(renderizador, &sala.partidas[sala.foco]->vista);
+    }
+    return true;
+}
+
+
+// Las partidas que eligieron salir se limpian y las demas se reacomodan en la ventana
+void quitarPartidasTerminadas(salaArcade& sala) {
+    bool quitada = false;
+    for (size_t i = 0; i < sala.partidas.size();) {
+        if (sala.partidas[i]->estadoDeJuego != SALIR) {
+            i++;
+            continue;
+        }
+        limpiarJuego(*sala.partidas[i]);
+        delete sala.partidas[i];
+        sala.partidas.erase(sala.partidas.begin() + i);
+        quitada = true;
+    }
+    if (quitada && !sala.partidas.empty()) enfocar(sala, std::min(sala.foco, (int)sala.partidas.size() - 1));
+}
+
+
+// Bucle principal, hasta que salgan todas las partidas
+void ejecutarSala(salaArcade& sala) {
+    recursosJuego& recursos = *sala.recursos;
+    while (!sala.partidas.empty()) {
+        temporizadorPerfil medirFrame(recursos.perfil, ETAPA_FRAME);
+
+        // Espera el plazo del frame; si todas estan en los menus alcanza con pocos frames por segundo
+        {
+            temporizadorPerfil medir(recursos.perfil, ETAPA_ESPERA);
+            bool quieta = true;
+            for (pong* juego : sala.partidas) quieta = quieta && pantallaQuieta(*juego);
+            esperarFrame(recursos.ritmo, quieta);
+        }
 
-    // Inicializar el eventoJuego
-        if (!inicializarJuego(juegoFinal)) {
-            return 1;
+        // Calcular tiempo transcurrido entre frames con el contador de alta resolucion
+        Uint64 fluidezDelJuego = SDL_GetPerformanceCounter();
+        for (pong* juego : sala.partidas) {
+            double tiempoTranscurridoEntreFrames = (double)(fluidezDelJuego - juego->lastTime) / SDL_GetPerformanceFrequency();
+            juego->lastTime = fluidezDelJuego;
+
+            // Un tirn largo (ventana arrastrada, breakpoint) no debe simular segundos de golpe
+            if (tiempoTranscurridoEntreFrames > MAXIMO_TIEMPO_POR_FRAME) tiempoTranscurridoEntreFrames = MAXIMO_TIEMPO_POR_FRAME;
+            juego->acumulador += tiempoTranscurridoEntreFrames;
         }
 
-    // Bucle principal
-    while (juegoFinal.juegoIniciado) {
-        // Calcular tiempo transcurrido entre frames
-        Uint32 fluidezDelJuego = SDL_GetTicks();
-        float tiempoTranscurridoEntreFrames = (fluidezDelJuego - juegoFinal.lastTime) / 1000.0f;
-        juegoFinal.lastTime = fluidezDelJuego;
+        // Recursos que terminaron de cargarse en otros hilos
+        if (!actualizarCarga(recursos)) {
+            for (pong* juego : sala.partidas) juego->estadoDeJuego = SALIR;
+        }
 
         // Manejar eventos
-        manejarEventos(juegoFinal);
+        {
+            temporizadorPerfil medir(recursos.perfil, ETAPA_EVENTOS);
+            manejarEventos(sala);
+        }
+
+        // Actualizar lgica: cada partida en el pool, los sonidos despues desde este hilo
+        {
+            temporizadorPerfil medir(recursos.perfil, ETAPA_ACTUALIZAR);
+            for (pong* juego : sala.partidas) encolarTarea(sala.pool, { actualizarPartida, juego });
+            ejecutarTareas(sala.pool);
+            for (pong* juego : sala.partidas) entregarEfectos(*juego);
+        }
 
-        // Actualizar lgica
-        actualizarJuego(juegoFinal, tiempoTranscurridoEntreFrames);
+        // Renderizar entre el paso anterior y el actual
+        actualizarPerfil(recursos.perfil);
+        bool mostrar;
+        {
+            temporizadorPerfil medir(recursos.perfil, ETAPA_RENDERIZAR);
+            mostrar = renderizarSala(sala);
+        }
 
-        // Renderizar
-        renderizarJuego(juegoFinal);
+        // Si en pantalla ya esta lo mismo no se presenta: se duerme hasta el proximo evento
+        if (mostrar) {
+            temporizadorPerfil medir(recursos.perfil, ETAPA_PRESENTAR);
+            SDL_RenderPresent(recursos.renderizar);
+            registrarPresentacionRitmo(recursos.ritmo);
+        }
+        else {
+            SDL_WaitEventTimeout(NULL, ESPERA_FRAME_QUIETO_MS);
+        }
+        for (pong* juego : sala.partidas) registrarPresentacion(juego->teclado);
 
         // Salir si est en estado EXIT
-        if (juegoFinal.estadoDeJuego == SALIR) {
-            juegoFinal.juegoIniciado = false;
+        quitarPartidasTerminadas(sala);
+    }
+}
+
+
+//Funcion principal para que funcione el juego, el cuerpo de todo el programa
+int main(int argc, char* argv[]) {
+    // Partida en linea: --servidor [puerto] espera y juega a la izquierda, --conectar host:puerto juega a la derecha
+    // --repeticion archivo la muestra; con --headless solo la vuelve a simular y verifica que coincida,
+    // con --capturar salida.y4m (o frames/%05d.png) la dibuja a archivo a --fps frames por segundo
+    // --mesas N juega N partidas independientes en la misma ventana, Tab o un click cambia la que recibe el teclado
+    bool sinVentana = false;
+    const char* conectar = nullptr;
+    const char* rutaRepeticion = nullptr;
+    const char* rutaCaptura = nullptr;
+    double fps = 0; // --fps N: N frames por segundo fijos en vez de vsync
+    int puertoServidor = 0;
+    int mesas = 1; // --mesas N: N partidas independientes en la misma ventana
+    int resultado = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--headless")) sinVentana = true;
+        else if (!strcmp(argv[i], "--servidor")) puertoServidor = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : PUERTO_RED;
+        else if (!strcmp(argv[i], "--conectar") && i + 1 < argc) conectar = argv[i + 1];
+        else if (!strcmp(argv[i], "--repeticion") && i + 1 < argc) rutaRepeticion = argv[i + 1];
+        else if (!strcmp(argv[i], "--fps") && i + 1 < argc) fps = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--capturar") && i + 1 < argc) rutaCaptura = argv[i + 1];
+        else if (!strcmp(argv[i], "--mesas") && i + 1 < argc) mesas = atoi(argv[i + 1]);
+    }
+
+    // Sin ventana ni sonido: solo simula partidas en lote e imprime estadisticas, o prueba la red
+    if (sinVentana && rutaRepeticion) return verificarRepeticion(rutaRepeticion);
+    if (sinVentana) return puertoServidor || conectar ? ejecutarRedSinVentana(argc, argv) : ejecutarSinVentana(argc, argv);
+    if (rutaCaptura && !rutaRepeticion) {
+        std::cerr << "--capturar necesita una repeticion: --repeticion archivo --capturar salida" << std::endl;
+        return 1;
+    }
+    if (mesas < 1 || (mesas > 1 && (puertoServidor || conectar || rutaRepeticion))) {
+        std::cerr << "--mesas N necesita N >= 1 y no se combina con la red ni con las repeticiones" << std::endl;
+        return 1;
+    }
+
+    // Recursos del proceso, compartidos por todas las partidas; los libera la ultima referencia
+    recursosJuego* recursos = new recursosJuego();
+    if (!crearRecursos(*recursos, fps, rutaCaptura != nullptr, mesas > 1)) {
+        delete recursos;
+        return 1;
+    }
+    salaArcade sala;
+    sala.recursos = recursos;
+    recursos->referencias++;
+
+    // Inicializar el eventoJuego, una partida por mesa
+    for (int i = 0; i < mesas; i++) {
+        pong* juego = new pong();
+        inicializarJuego(*juego, recursos);
+        sala.partidas.push_back(juego);
+    }
+    enfocar(sala, 0);
+    pong& juegoFinal = *sala.partidas[0];
+
+    if (puertoServidor || conectar) {
+        bool conectado = puertoServidor ? iniciarServidor(juegoFinal.red, (uint16_t)puertoServidor) : iniciarCliente(juegoFinal.red, conectar);
+        juegoFinal.estadoDeJuego = conectado ? ESPERANDO_RED : SALIR;
+        if (!conectado) resultado = 1;
+    }
+    else if (rutaRepeticion) {
+        if (!abrirRepeticion(rutaRepeticion, juegoFinal.repeticion)) {
+            juegoFinal.estadoDeJuego = SALIR;
+            resultado = 1;
+        }
+        else {
+            juegoFinal.velocidadRepeticion = 1;
+            juegoFinal.reglasPartida = juegoFinal.repeticion.reglas;
+            juegoFinal.estadoDeJuego = REPRODUCIENDO;
+            saltarRepeticion(juegoFinal, 0);
+            if (rutaCaptura) {
+                resultado = capturarRepeticion(juegoFinal, rutaCaptura, fps);
+                juegoFinal.estadoDeJuego = SALIR;
+            }
         }
     }
+    quitarPartidasTerminadas(sala); // Si no se pudo conectar o abrir la repeticion, o ya se capturo
+
+    // Un hilo por mesa, sin pasar los nucleos; el hilo principal simula tambien
+    int nucleos = SDL_GetCPUCount();
+    iniciarPool(sala.pool, std::max(0, std::min(mesas, nucleos) - 1));
+    ejecutarSala(sala);
+    cerrarPool(sala.pool);
 
     // Limpiar recursos
-    limpiarJuego(juegoFinal);
+    soltarRecursos(recursos);
 
-    return 0;
+    return resultado;
 } 
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Formato del paquete de recursos (assets/pong.pak) que arma el empaquetador.
+// Cabecera, indice de entradas y despues los datos, cada uno alineado a 16 bytes.
+// Las imagenes ya estan en ARGB8888 y los sonidos en el formato del mezclador,
+// asi el juego crea texturas y Mix_Chunk directo desde el archivo mapeado en memoria.
+
+
+const char FIRMA_PAQUETE[8] = { 'P', 'O', 'N', 'G', 'P', 'A', 'K', '1' };
+const uint32_t VERSION_PAQUETE = 1;
+const int ALINEACION_PAQUETE = 16;
+
+// Formato de audio del mezclador: el mismo que se pide en Mix_OpenAudio
+const int FRECUENCIA_MEZCLADOR = 44100;
+const int CANALES_MEZCLADOR = 2;
+
+// Bytes de la cabecera WAV que el empaquetador escribe delante de cada sonido
+const int CABECERA_WAV = 44;
+
+
+enum tipoRecurso : uint32_t {
+    RECURSO_TEXTURA, // Pixeles crudos (formato, ancho, alto, pitch)
+    RECURSO_SONIDO, // WAV PCM ya convertido al formato del mezclador
+    RECURSO_FUENTE // Archivo TTF tal cual
+};
+
+
+struct cabeceraPaquete {
+    char firma[8];
+    uint32_t version;
+    uint32_t cantidad; // Entradas del indice
+};
+
+
+struct entradaPaquete {
+    char nombre[48]; // Nombre del archivo original, por ejemplo "star-wars-fondo.bmp"
+    uint32_t tipo;
+    uint32_t formato; // Formato de pixel de SDL o formato de audio de SDL
+    int32_t ancho, alto, pitch; // Solo texturas
+    int32_t frecuencia, canales; // Solo sonidos
+    uint32_t reservado;
+    uint64_t inicio; // Desde el principio del archivo
+    uint64_t tamanio;
+};
+
+static_assert(sizeof(cabeceraPaquete) == 16, "cabeceraPaquete debe medir 16 bytes");
+static_assert(sizeof(entradaPaquete) == 96, "entradaPaquete debe medir 96 bytes");
+
+
+// Archivo abierto en memoria de solo lectura
+struct paqueteRecursos {
+    const uint8_t* datos = nullptr;
+    size_t tamanio = 0;
+    const entradaPaquete* entradas = nullptr;
+    uint32_t cantidad = 0;
+#ifdef _WIN32
+    HANDLE archivo = INVALID_HANDLE_VALUE;
+    HANDLE mapeo = NULL;
+#endif
+};
+
+
+inline void cerrarPaquete(paqueteRecursos& paquete) {
+    if (!paquete.datos) return;
+#ifdef _WIN32
+    UnmapViewOfFile(paquete.datos);
+    CloseHandle(paquete.mapeo);
+    CloseHandle(paquete.archivo);
+    paquete.mapeo = NULL;
+    paquete.archivo = INVALID_HANDLE_VALUE;
+#else
+    munmap((void*)paquete.datos, paquete.tamanio);
+#endif
+    paquete = paqueteRecursos();
+}
+
+
+// Mapea el paquete en memoria y revisa el indice; no copia ningun dato
+inline bool abrirPaquete(const char* ruta, paqueteRecursos& paquete) {
+#ifdef _WIN32
+    paquete.archivo = CreateFileA(ruta, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (paquete.archivo == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER tamanio;
+    if (!GetFileSizeEx(paquete.archivo, &tamanio) || tamanio.QuadPart < (LONGLONG)sizeof(cabeceraPaquete)) {
+        CloseHandle(paquete.archivo);
+        paquete.archivo = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    paquete.mapeo = CreateFileMappingA(paquete.archivo, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* datos = paquete.mapeo ? MapViewOfFile(paquete.mapeo, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!datos) {
+        if (paquete.mapeo) CloseHandle(paquete.mapeo);
+        CloseHandle(paquete.archivo);
+        paquete = paqueteRecursos();
+        return false;
+    }
+    paquete.tamanio = (size_t)tamanio.QuadPart;
+#else
+    int archivo = open(ruta, O_RDONLY);
+    if (archivo < 0) return false;
+    struct stat informacion;
+    if (fstat(archivo, &informacion) < 0 || informacion.st_size < (off_t)sizeof(cabeceraPaquete)) {
+        close(archivo);
+        return false;
+    }
+    void* datos = mmap(NULL, (size_t)informacion.st_size, PROT_READ, MAP_PRIVATE, archivo, 0);
+    close(archivo);
+    if (datos == MAP_FAILED) return false;
+    paquete.tamanio = (size_t)informacion.st_size;
+#endif
+    paquete.datos = (const uint8_t*)datos;
+
+    // Revisar firma, version y que el indice y los datos entren en el archivo
+    const cabeceraPaquete* cabecera = (const cabeceraPaquete*)paquete.datos;
+    size_t finIndice = sizeof(cabeceraPaquete) + (size_t)cabecera->cantidad * sizeof(entradaPaquete);
+    if (memcmp(cabecera->firma, FIRMA_PAQUETE, sizeof(FIRMA_PAQUETE)) != 0 || cabecera->version != VERSION_PAQUETE || finIndice > paquete.tamanio) {
+        cerrarPaquete(paquete);
+        return false;
+    }
+    paquete.entradas = (const entradaPaquete*)(paquete.datos + sizeof(cabeceraPaquete));
+    paquete.cantidad = cabecera->cantidad;
+    for (uint32_t i = 0; i < paquete.cantidad; i++) {
+        const entradaPaquete& entrada = paquete.entradas[i];
+        if (entrada.inicio < finIndice || entrada.inicio > paquete.tamanio || entrada.tamanio > paquete.tamanio - entrada.inicio) {
+            cerrarPaquete(paquete);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Busca una entrada por nombre y tipo, nullptr si no esta
+inline const entradaPaquete* buscarRecurso(const paqueteRecursos& paquete, const char* nombre, tipoRecurso tipo) {
+    for (uint32_t i = 0; i < paquete.cantidad; i++) {
+        const entradaPaquete& entrada = paquete.entradas[i];
+        if (entrada.tipo == tipo && strncmp(entrada.nombre, nombre, sizeof(entrada.nombre)) == 0) return &entrada;
+    }
+    return nullptr;
+}
+
+
+// Puntero a los datos de una entrada dentro del mapeo
+inline const uint8_t* datosRecurso(const paqueteRecursos& paquete, const entradaPaquete& entrada) {
+    return paquete.datos + entrada.inicio;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Medicion del tiempo de cada frame: temporizadores por bloque que dejan muestras en un anillo,
+// un panel que se prende con F3 (FPS, p50/p99 y una barra por etapa) y una traza en formato
+// de Chrome (chrome://tracing o Perfetto) que se escribe al salir.
+
+
+// Muestras guardadas; a 60 FPS con 6 muestras por frame alcanzan para mas de un minuto y medio
+const int CAPACIDAD_PERFIL = 1 << 15;
+
+// Frames que se usan para las estadisticas del panel y cada cuanto se recalculan (segundos)
+const int FRAMES_ESTADISTICAS = 240;
+const double INTERVALO_ESTADISTICAS = 0.5;
+
+const char RUTA_TRAZA[] = "perfil.json";
+
+
+enum etapaPerfil {
+    ETAPA_FRAME, // Una vuelta entera del bucle principal
+    ETAPA_EVENTOS,
+    ETAPA_ACTUALIZAR,
+    ETAPA_RENDERIZAR,
+    ETAPA_TEXTO, // Dentro de ETAPA_RENDERIZAR: el lote de texto al renderizador
+    ETAPA_PRESENTAR,
+    ETAPA_ESPERA, // Lo que se duerme para respetar el ritmo de frames
+    TOTAL_ETAPAS
+};
+
+const char* const NOMBRES_ETAPAS[TOTAL_ETAPAS] = {
+    "frame", "manejarEventos", "actualizarJuego", "renderizarJuego", "renderizarTexto", "SDL_RenderPresent", "esperarFrame"
+};
+
+
+struct muestraPerfil {
+    Uint64 inicio; // Contador de alto rendimiento
+    Uint64 fin;
+    int etapa;
+};
+
+
+struct estadisticasPerfil {
+    double fps = 0;
+    double p50 = 0, p99 = 0; // Milisegundos por frame
+    double promedio[TOTAL_ETAPAS] = {}; // Milisegundos por frame de cada etapa
+};
+
+
+// Anillo sin bloqueos: un solo hilo escribe (el principal) y nunca espera. Cuando se llena
+// pisa las muestras mas viejas; quien lee toma desde max(0, escritas - CAPACIDAD_PERFIL).
+struct perfilFrames {
+    std::vector<muestraPerfil> muestras;
+    std::atomic<uint64_t> escritas{ 0 };
+
+    bool visible = false;
+    estadisticasPerfil estadisticas;
+    Uint64 ultimoCalculo = 0;
+    std::vector<double> duraciones; // Reservado una vez para ordenar los frames
+};
+
+
+inline void crearPerfil(perfilFrames& perfil) {
+    perfil.muestras.resize(CAPACIDAD_PERFIL);
+    perfil.duraciones.reserve(FRAMES_ESTADISTICAS);
+}
+
+
+inline void registrarMuestra(perfilFrames& perfil, int etapa, Uint64 inicio, Uint64 fin) {
+    uint64_t i = perfil.escritas.load(std::memory_order_relaxed);
+    perfil.muestras[i & (CAPACIDAD_PERFIL - 1)] = { inicio, fin, etapa };
+    perfil.escritas.store(i + 1, std::memory_order_release);
+}
+
+
+// Mide desde que se crea hasta que sale del bloque
+struct temporizadorPerfil {
+    perfilFrames& perfil;
+    int etapa;
+    Uint64 inicio;
+
+    temporizadorPerfil(perfilFrames& perfil, int etapa) : perfil(perfil), etapa(etapa), inicio(SDL_GetPerformanceCounter()) {}
+    ~temporizadorPerfil() { registrarMuestra(perfil, etapa, inicio, SDL_GetPerformanceCounter()); }
+};
+
+
+// Recorre los ultimos FRAMES_ESTADISTICAS frames de mas nuevo a mas viejo
+inline void calcularEstadisticas(perfilFrames& perfil) {
+    uint64_t escritas = perfil.escritas.load(std::memory_order_acquire);
+    uint64_t primera = escritas > CAPACIDAD_PERFIL ? escritas - CAPACIDAD_PERFIL : 0;
+    double milisegundosPorTic = 1000.0 / SDL_GetPerformanceFrequency();
+
+    estadisticasPerfil resultado;
+    perfil.duraciones.clear();
+    Uint64 desde = 0;
+    uint64_t hasta = 0; // Despues del frame completo mas nuevo
+    for (uint64_t i = escritas; i > primera && (int)perfil.duraciones.size() < FRAMES_ESTADISTICAS; i--) {
+        const muestraPerfil& muestra = perfil.muestras[(i - 1) & (CAPACIDAD_PERFIL - 1)];
+        if (muestra.etapa == ETAPA_FRAME) {
+            perfil.duraciones.push_back((muestra.fin - muestra.inicio) * milisegundosPorTic);
+            desde = muestra.inicio;
+            if (!hasta) hasta = i;
+        }
+    }
+    int frames = (int)perfil.duraciones.size();
+    if (frames == 0) return;
+
+    // Solo las etapas de los frames completos que se contaron
+    for (uint64_t i = hasta; i > primera; i--) {
+        const muestraPerfil& muestra = perfil.muestras[(i - 1) & (CAPACIDAD_PERFIL - 1)];
+        if (muestra.inicio < desde) break;
+        resultado.promedio[muestra.etapa] += (muestra.fin - muestra.inicio) * milisegundosPorTic;
+    }
+    for (int etapa = 0; etapa < TOTAL_ETAPAS; etapa++) resultado.promedio[etapa] /= frames;
+
+    std::vector<double>& d = perfil.duraciones;
+    std::nth_element(d.begin(), d.begin() + frames / 2, d.end());
+    resultado.p50 = d[frames / 2];
+    int indice99 = std::min(frames - 1, frames * 99 / 100);
+    std::nth_element(d.begin(), d.begin() + indice99, d.end());
+    resultado.p99 = d[indice99];
+    resultado.fps = resultado.promedio[ETAPA_FRAME] > 0 ? 1000.0 / resultado.promedio[ETAPA_FRAME] : 0;
+    perfil.estadisticas = resultado;
+}
+
+
+// Recalcula las estadisticas cada INTERVALO_ESTADISTICAS, solo si el panel esta a la vista
+inline void actualizarPerfil(perfilFrames& perfil) {
+    if (!perfil.visible) return;
+    Uint64 ahora = SDL_GetPerformanceCounter();
+    if ((double)(ahora - perfil.ultimoCalculo) / SDL_GetPerformanceFrequency() < INTERVALO_ESTADISTICAS) return;
+    perfil.ultimoCalculo = ahora;
+    calcularEstadisticas(perfil);
+}
+
+
+// Escribe las muestras guardadas como eventos completos ("ph":"X") en microsegundos
+inline bool escribirTraza(const perfilFrames& perfil, const char* ruta) {
+    uint64_t escritas = perfil.escritas.load(std::memory_order_acquire);
+    if (escritas == 0) return true;
+    uint64_t primera = escritas > CAPACIDAD_PERFIL ? escritas - CAPACIDAD_PERFIL : 0;
+
+    FILE* archivo = fopen(ruta, "w");
+    if (!archivo) {
+        std::cerr << "Error creando " << ruta << std::endl;
+        return false;
+    }
+    double microsegundosPorTic = 1000000.0 / SDL_GetPerformanceFrequency();
+    // El frame se registra despues de sus etapas, asi que el origen es el inicio mas chico
+    Uint64 origen = perfil.muestras[primera & (CAPACIDAD_PERFIL - 1)].inicio;
+    for (uint64_t i = primera; i < escritas; i++) origen = std::min(origen, perfil.muestras[i & (CAPACIDAD_PERFIL - 1)].inicio);
+    fprintf(archivo, "{\"traceEvents\":[\n");
+    for (uint64_t i = primera; i < escritas; i++) {
+        const muestraPerfil& muestra = perfil.muestras[i & (CAPACIDAD_PERFIL - 1)];
+        fprintf(archivo, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            NOMBRES_ETAPAS[muestra.etapa],
+            (double)(muestra.inicio - origen) * microsegundosPorTic,
+            (double)(muestra.fin - muestra.inicio) * microsegundosPorTic,
+            i + 1 < escritas ? "," : "");
+    }
+    fprintf(archivo, "],\"displayTimeUnit\":\"ms\"}\n");
+    bool correcto = !ferror(archivo);
+    fclose(archivo);
+    if (!correcto) std::cerr << "Error escribiendo " << ruta << std::endl;
+    return correcto;
+}
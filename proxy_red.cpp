@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "red.h"
+
+// Herramienta aparte para probar el modo en linea con una red mala en la misma maquina:
+// reenvia los datagramas entre el cliente y el servidor perdiendo, retrasando y desordenando algunos.
+// Uso: proxy_red <puerto> <servidor:puerto> [--perdida 0.05] [--retraso 50] [--variacion 20] [--semilla 1]
+// El servidor escucha en su puerto y el cliente se conecta al puerto del proxy.
+
+
+struct datagramaDemorado {
+    double salida; // relojRed() en el que se envia
+    sockaddr_in destino;
+    int tamanio;
+    char datos[512];
+};
+
+
+struct configuracionProxy {
+    uint16_t puerto = 0;
+    sockaddr_in servidor = {};
+    double perdida = 0.05; // Probabilidad de perder cada datagrama
+    double retraso = 0.050; // Segundos en cada sentido
+    double variacion = 0.020; // Segundos de mas o de menos, al azar
+    uint32_t semilla = 1;
+};
+
+
+bool leerConfiguracionProxy(int argc, char* argv[], configuracionProxy& configuracion) {
+    if (argc < 3) return false;
+    configuracion.puerto = (uint16_t)atoi(argv[1]);
+    if (!iniciarSockets() || !resolverDireccion(argv[2], PUERTO_RED, configuracion.servidor)) {
+        std::fprintf(stderr, "No se encontro la direccion %s\n", argv[2]);
+        return false;
+    }
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const char* opcion = argv[i];
+        const char* valor = argv[i + 1];
+        if (!strcmp(opcion, "--perdida")) configuracion.perdida = atof(valor);
+        else if (!strcmp(opcion, "--retraso")) configuracion.retraso = atof(valor) / 1000;
+        else if (!strcmp(opcion, "--variacion")) configuracion.variacion = atof(valor) / 1000;
+        else if (!strcmp(opcion, "--semilla")) configuracion.semilla = (uint32_t)strtoul(valor, nullptr, 10);
+        else {
+            std::fprintf(stderr, "Opcion desconocida: %s\n", opcion);
+            return false;
+        }
+    }
+    return configuracion.puerto != 0 && configuracion.semilla != 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    configuracionProxy configuracion;
+    if (!leerConfiguracionProxy(argc, argv, configuracion)) {
+        std::fprintf(stderr, "Uso: proxy_red <puerto> <servidor:puerto> [--perdida 0.05] [--retraso 50] [--variacion 20] [--semilla 1]\n");
+        return 1;
+    }
+    socketRed s = abrirSocketUdp(configuracion.puerto);
+    if (s == SOCKET_INVALIDO) {
+        std::fprintf(stderr, "No se pudo abrir el puerto UDP %d\n", configuracion.puerto);
+        return 1;
+    }
+
+    // Lo que viene del servidor va al ultimo cliente que se vio; lo demas va al servidor
+    sockaddr_in cliente = {};
+    std::vector<datagramaDemorado> enCamino;
+    uint32_t azar = configuracion.semilla;
+    long long reenviados = 0, perdidos = 0;
+    double proximoInforme = relojRed() + 5.0;
+
+    while (true) {
+        datagramaDemorado datagrama;
+        sockaddr_in origen;
+        while ((datagrama.tamanio = recibirDatagrama(s, datagrama.datos, sizeof(datagrama.datos), origen)) >= 0) {
+            bool delServidor = mismaDireccion(origen, configuracion.servidor);
+            if (!delServidor) cliente = origen;
+            if (delServidor && !cliente.sin_port) continue;
+            if ((siguienteAzar(azar) & 0xFFFF) < configuracion.perdida * 65536) {
+                perdidos++;
+                continue;
+            }
+            // Con variacion los datagramas pueden llegar desordenados, como en una red real
+            double demora = configuracion.retraso + azarCentrado(azar) * configuracion.variacion;
+            datagrama.salida = relojRed() + (demora > 0 ? demora : 0);
+            datagrama.destino = delServidor ? cliente : configuracion.servidor;
+            enCamino.push_back(datagrama);
+        }
+
+        double ahora = relojRed();
+        for (size_t i = 0; i < enCamino.size(); ) {
+            if (enCamino[i].salida > ahora) {
+                i++;
+                continue;
+            }
+            enviarDatagrama(s, enCamino[i].datos, enCamino[i].tamanio, enCamino[i].destino);
+            reenviados++;
+            enCamino[i] = enCamino.back();
+            enCamino.pop_back();
+        }
+
+        if (ahora >= proximoInforme) {
+            std::fprintf(stderr, "reenviados %lld, perdidos %lld\n", reenviados, perdidos);
+            proximoInforme = ahora + 5.0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
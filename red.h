@@ -0,0 +1,592 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "simulacion.h"
+
+// Partida en linea por UDP con rollback: cada jugador simula enseguida con su propia entrada y
+// la del otro predicha (la ultima que llego). Cuando llega una entrada real distinta de la predicha
+// se vuelve al estado guardado de ese paso y se simula de nuevo hasta el presente. Cada paquete
+// repite todas las entradas que el otro todavia no confirmo, asi un paquete perdido no frena nada.
+
+
+const uint16_t PUERTO_RED = 7777;
+
+// Pasos que se pueden predecir sin entrada del otro (~266 ms): alcanza para 100 ms de ida y vuelta con margen
+const int MAXIMO_ROLLBACK = 32;
+const int HISTORIAL_RED = 128; // Potencia de 2, mas del doble de MAXIMO_ROLLBACK
+const int ENTRADAS_POR_PAQUETE = 32;
+const double INTERVALO_HOLA = 0.1; // Segundos entre intentos de conexion
+const double TIEMPO_SIN_RESPUESTA = 5.0; // Segundos sin paquetes para dar la conexion por perdida
+
+const uint32_t FIRMA_RED = 0x474E4F50; // "PONG"
+
+static_assert(std::is_trivially_copyable<estadoSimulacion>::value, "estadoSimulacion se copia en cada paso, debe ser POD");
+
+
+#ifdef _WIN32
+typedef SOCKET socketRed;
+const socketRed SOCKET_INVALIDO = INVALID_SOCKET;
+#else
+typedef int socketRed;
+const socketRed SOCKET_INVALIDO = -1;
+#endif
+
+
+enum tipoPaqueteRed : uint8_t { PAQUETE_HOLA, PAQUETE_BIENVENIDA, PAQUETE_ENTRADAS, PAQUETE_ADIOS };
+enum ladoRed { LADO_IZQUIERDO, LADO_DERECHO };
+enum estadoRed { RED_DESCONECTADA, RED_ESPERANDO, RED_CONECTADA, RED_PERDIDA };
+
+
+// Teclas de un jugador en un paso: arriba, abajo, izquierda, derecha (fraccion del paso en 255avos)
+struct entradaJugador {
+    uint8_t presionada[4];
+};
+
+
+// Todo viaja tal cual en memoria: los dos lados son el mismo programa
+struct paqueteRed {
+    uint32_t firma;
+    uint8_t tipo;
+    uint8_t cantidad; // Entradas validas
+    int8_t ventaja; // Pasos que el que envia va adelantado respecto de lo que recibio
+    uint8_t reservado;
+    int32_t primerPaso; // Paso de entradas[0]
+    int32_t ultimoRecibido; // Ultimo paso del destinatario que el que envia ya tiene, -1 si ninguno
+    int32_t pasoVerificado; // Paso ya confirmado por ambos cuyo estado resume suma
+    uint32_t suma;
+    entradaJugador entradas[ENTRADAS_POR_PAQUETE];
+};
+
+
+struct sesionRed {
+    socketRed socket = SOCKET_INVALIDO;
+    sockaddr_in remoto = {};
+    bool servidor = false;
+    ladoRed lado = LADO_IZQUIERDO;
+    estadoRed estado = RED_DESCONECTADA;
+    double ultimoEnvio = 0, ultimaRecepcion = 0;
+
+    int32_t paso = 0; // Proximo paso a simular
+    int32_t ultimoRemoto = -1; // Ultimo paso con la entrada real del otro (todos los anteriores tambien)
+    int32_t confirmadoPorRemoto = -1; // Ultimo paso nuestro que el otro ya tiene
+    int32_t corregirDesde = -1; // Primer paso simulado con una prediccion equivocada, -1 si ninguno
+    int ventajaRemota = 0;
+    int32_t primerPasoRemoto = -1; // primerPaso del paquete mas nuevo, para no tomar la ventaja de uno viejo
+
+    // Anillos indexados por paso: entradas usadas y estado antes de simular ese paso
+    entradaJugador local[HISTORIAL_RED] = {};
+    entradaJugador remota[HISTORIAL_RED] = {};
+    estadoSimulacion estados[HISTORIAL_RED];
+    int32_t pasosGuardados[HISTORIAL_RED]; // De que paso es cada estado, -1 si ninguno
+
+    // Para el panel y las pruebas
+    int rollbacks = 0;
+    long long pasosResimulados = 0;
+    bool desincronizada = false;
+};
+
+
+inline double relojRed() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+inline int indiceRed(int32_t paso) {
+    return paso & (HISTORIAL_RED - 1);
+}
+
+
+inline void guardarEstadoRed(sesionRed& sesion, int32_t paso, const estadoSimulacion& estado) {
+    sesion.estados[indiceRed(paso)] = estado;
+    sesion.pasosGuardados[indiceRed(paso)] = paso;
+}
+
+
+// Resumen del estado campo por campo (el relleno de la estructura no cuenta), FNV-1a
+inline uint32_t sumaEstado(const estadoSimulacion& estado) {
+    const float flotantes[] = { estado.paletaIzquierda.x, estado.paletaIzquierda.y, estado.paletaDerecha.x, estado.paletaDerecha.y,
+        estado.pelota.x, estado.pelota.y, estado.pelota.vx, estado.pelota.vy };
+    const int enteros[] = { estado.paletaIzquierda.puntaje, estado.paletaDerecha.puntaje, estado.ganador };
+    uint32_t suma = 2166136261u;
+    const uint8_t* bytes = (const uint8_t*)flotantes;
+    for (size_t i = 0; i < sizeof(flotantes); i++) suma = (suma ^ bytes[i]) * 16777619u;
+    bytes = (const uint8_t*)enteros;
+    for (size_t i = 0; i < sizeof(enteros); i++) suma = (suma ^ bytes[i]) * 16777619u;
+    return suma;
+}
+
+
+// Cada jugador maneja su paleta con W/S/A/D o con las flechas, lo que prefiera
+inline entradaJugador entradaLocal(const entradasPaso& teclado) {
+    entradaJugador entrada;
+    for (int i = 0; i < 4; i++) {
+        uint8_t izquierda = teclado.presionada[i], derecha = teclado.presionada[i + 4];
+        entrada.presionada[i] = izquierda > derecha ? izquierda : derecha;
+    }
+    return entrada;
+}
+
+
+inline entradasPaso combinarEntradas(const entradaJugador& izquierda, const entradaJugador& derecha) {
+    entradasPaso paso;
+    memcpy(paso.presionada, izquierda.presionada, 4);
+    memcpy(paso.presionada + 4, derecha.presionada, 4);
+    return paso;
+}
+
+
+// Sockets
+
+inline bool iniciarSockets() {
+#ifdef _WIN32
+    WSADATA datos;
+    return WSAStartup(MAKEWORD(2, 2), &datos) == 0;
+#else
+    return true;
+#endif
+}
+
+
+inline void cerrarSocket(socketRed& s) {
+    if (s == SOCKET_INVALIDO) return;
+#ifdef _WIN32
+    closesocket(s);
+#else
+    close(s);
+#endif
+    s = SOCKET_INVALIDO;
+}
+
+
+// Socket UDP sin bloqueo; puerto 0 elige uno libre
+inline socketRed abrirSocketUdp(uint16_t puerto) {
+    socketRed s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == SOCKET_INVALIDO) return s;
+    sockaddr_in direccion = {};
+    direccion.sin_family = AF_INET;
+    direccion.sin_addr.s_addr = htonl(INADDR_ANY);
+    direccion.sin_port = htons(puerto);
+#ifdef _WIN32
+    u_long sinBloqueo = 1;
+    bool correcto = bind(s, (sockaddr*)&direccion, sizeof(direccion)) == 0 && ioctlsocket(s, FIONBIO, &sinBloqueo) == 0;
+#else
+    bool correcto = bind(s, (sockaddr*)&direccion, sizeof(direccion)) == 0 && fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!correcto) cerrarSocket(s);
+    return s;
+}
+
+
+// "host:puerto" o "host" (usa el puerto por defecto)
+inline bool resolverDireccion(const char* texto, uint16_t puertoPorDefecto, sockaddr_in& direccion) {
+    char host[256];
+    strncpy(host, texto, sizeof(host) - 1);
+    host[sizeof(host) - 1] = 0;
+    uint16_t puerto = puertoPorDefecto;
+    char* separador = strrchr(host, ':');
+    if (separador) {
+        *separador = 0;
+        puerto = (uint16_t)atoi(separador + 1);
+    }
+
+    addrinfo pedido = {}, *resultado = nullptr;
+    pedido.ai_family = AF_INET;
+    pedido.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, nullptr, &pedido, &resultado) != 0 || !resultado) return false;
+    direccion = *(const sockaddr_in*)resultado->ai_addr;
+    direccion.sin_port = htons(puerto);
+    freeaddrinfo(resultado);
+    return true;
+}
+
+
+// Devuelve los bytes recibidos o -1 si no habia nada
+inline int recibirDatagrama(socketRed s, void* datos, int tamanio, sockaddr_in& origen) {
+#ifdef _WIN32
+    int largo = sizeof(origen);
+#else
+    socklen_t largo = sizeof(origen);
+#endif
+    int recibidos = (int)recvfrom(s, (char*)datos, tamanio, 0, (sockaddr*)&origen, &largo);
+    return recibidos < 0 ? -1 : recibidos;
+}
+
+
+inline void enviarDatagrama(socketRed s, const void* datos, int tamanio, const sockaddr_in& destino) {
+    sendto(s, (const char*)datos, tamanio, 0, (const sockaddr*)&destino, sizeof(destino));
+}
+
+
+inline bool mismaDireccion(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+
+// Sesion
+
+// El servidor espera en su puerto y juega a la izquierda
+inline bool iniciarServidor(sesionRed& sesion, uint16_t puerto) {
+    sesion = sesionRed();
+    if (!iniciarSockets()) return false;
+    sesion.socket = abrirSocketUdp(puerto);
+    if (sesion.socket == SOCKET_INVALIDO) {
+        fprintf(stderr, "No se pudo abrir el puerto UDP %d\n", puerto);
+        return false;
+    }
+    sesion.servidor = true;
+    sesion.lado = LADO_IZQUIERDO;
+    sesion.estado = RED_ESPERANDO;
+    return true;
+}
+
+
+// El cliente llama a "host:puerto" y juega a la derecha
+inline bool iniciarCliente(sesionRed& sesion, const char* direccion) {
+    sesion = sesionRed();
+    if (!iniciarSockets()) return false;
+    if (!resolverDireccion(direccion, PUERTO_RED, sesion.remoto)) {
+        fprintf(stderr, "No se encontro la direccion %s\n", direccion);
+        return false;
+    }
+    sesion.socket = abrirSocketUdp(0);
+    if (sesion.socket == SOCKET_INVALIDO) {
+        fprintf(stderr, "No se pudo abrir un socket UDP\n");
+        return false;
+    }
+    sesion.lado = LADO_DERECHO;
+    sesion.estado = RED_ESPERANDO;
+    return true;
+}
+
+
+inline void cerrarRed(sesionRed& sesion) {
+    if (sesion.estado == RED_CONECTADA) {
+        paqueteRed adios = {};
+        adios.firma = FIRMA_RED;
+        adios.tipo = PAQUETE_ADIOS;
+        enviarDatagrama(sesion.socket, &adios, sizeof(adios), sesion.remoto);
+    }
+    cerrarSocket(sesion.socket);
+    sesion.estado = RED_DESCONECTADA;
+}
+
+
+// Ambos empiezan del mismo estado en el paso 0
+inline void empezarPartidaRed(sesionRed& sesion, const estadoSimulacion& inicial) {
+    sesion.estado = RED_CONECTADA;
+    sesion.paso = 0;
+    sesion.ultimoRemoto = -1;
+    sesion.confirmadoPorRemoto = -1;
+    sesion.corregirDesde = -1;
+    sesion.ventajaRemota = 0;
+    sesion.primerPasoRemoto = -1;
+    for (int32_t& guardado : sesion.pasosGuardados) guardado = -1;
+    guardarEstadoRed(sesion, 0, inicial);
+    sesion.ultimaRecepcion = relojRed();
+}
+
+
+// Paso cuyo estado guardado ya no puede cambiar (todas las entradas anteriores son reales), -1 si ninguno
+inline int32_t pasoVerificable(const sesionRed& sesion) {
+    if (sesion.corregirDesde >= 0) return -1;
+    int32_t paso = sesion.ultimoRemoto + 1 < sesion.paso - 1 ? sesion.ultimoRemoto + 1 : sesion.paso - 1;
+    return paso > sesion.paso - HISTORIAL_RED ? paso : -1;
+}
+
+
+// Guarda las entradas reales del otro y marca desde donde hay que corregir
+inline void recibirEntradas(sesionRed& sesion, const paqueteRed& paquete) {
+    // Un paquete atrasado o desordenado trae una ventaja vieja: solo cuenta la del mas nuevo
+    if (paquete.ultimoRecibido >= sesion.confirmadoPorRemoto && paquete.primerPaso >= sesion.primerPasoRemoto) {
+        sesion.ventajaRemota = paquete.ventaja;
+        sesion.primerPasoRemoto = paquete.primerPaso;
+    }
+    if (paquete.ultimoRecibido > sesion.confirmadoPorRemoto) sesion.confirmadoPorRemoto = paquete.ultimoRecibido;
+
+    for (int i = 0; i < paquete.cantidad && i < ENTRADAS_POR_PAQUETE; i++) {
+        int32_t paso = paquete.primerPaso + i;
+        // Solo en orden y sin salirse del historial
+        if (paso != sesion.ultimoRemoto + 1 || paso >= sesion.paso + HISTORIAL_RED / 2) continue;
+        entradaJugador& guardada = sesion.remota[indiceRed(paso)];
+        if (paso < sesion.paso && memcmp(&guardada, &paquete.entradas[i], sizeof(entradaJugador)) != 0) {
+            if (sesion.corregirDesde < 0 || paso < sesion.corregirDesde) sesion.corregirDesde = paso;
+        }
+        guardada = paquete.entradas[i];
+        sesion.ultimoRemoto = paso;
+    }
+
+    // El estado antes de un paso confirmado por los dos tiene que ser igual de ambos lados. Un paquete
+    // atrasado puede verificar un paso cuyo lugar en el anillo ya tiene otro estado: ese no se compara
+    int32_t verificado = paquete.pasoVerificado;
+    if (verificado >= 0 && verificado > sesion.paso - HISTORIAL_RED && verificado <= pasoVerificable(sesion) &&
+        sesion.pasosGuardados[indiceRed(verificado)] == verificado) {
+        if (sumaEstado(sesion.estados[indiceRed(verificado)]) != paquete.suma) sesion.desincronizada = true;
+    }
+}
+
+
+inline void enviarPaquete(sesionRed& sesion, paqueteRed& paquete) {
+    paquete.firma = FIRMA_RED;
+    enviarDatagrama(sesion.socket, &paquete, sizeof(paquete), sesion.remoto);
+    sesion.ultimoEnvio = relojRed();
+}
+
+
+// Lee todo lo que llego; antes de conectar atiende el saludo
+inline void recibirRed(sesionRed& sesion) {
+    paqueteRed paquete;
+    sockaddr_in origen;
+    int recibidos;
+    while ((recibidos = recibirDatagrama(sesion.socket, &paquete, sizeof(paquete), origen)) >= 0) {
+        if (recibidos != (int)sizeof(paquete) || paquete.firma != FIRMA_RED) continue;
+
+        // El servidor acepta al primero que saluda y le contesta cada vez, por si se perdio la bienvenida
+        if (sesion.servidor && paquete.tipo == PAQUETE_HOLA) {
+            if (sesion.estado == RED_ESPERANDO) sesion.remoto = origen;
+            if (!mismaDireccion(origen, sesion.remoto)) continue;
+            paqueteRed bienvenida = {};
+            bienvenida.tipo = PAQUETE_BIENVENIDA;
+            enviarPaquete(sesion, bienvenida);
+            if (sesion.estado == RED_ESPERANDO) sesion.estado = RED_CONECTADA;
+            continue;
+        }
+        if (!mismaDireccion(origen, sesion.remoto)) continue;
+        sesion.ultimaRecepcion = relojRed();
+
+        if (paquete.tipo == PAQUETE_BIENVENIDA && sesion.estado == RED_ESPERANDO) sesion.estado = RED_CONECTADA;
+        else if (paquete.tipo == PAQUETE_ENTRADAS && sesion.estado == RED_CONECTADA) recibirEntradas(sesion, paquete);
+        else if (paquete.tipo == PAQUETE_ADIOS) sesion.estado = RED_PERDIDA;
+    }
+}
+
+
+// Mientras espera: el cliente saluda cada INTERVALO_HOLA. Devuelve true cuando ya hay con quien jugar.
+inline bool conectarRed(sesionRed& sesion) {
+    if (sesion.estado == RED_ESPERANDO && !sesion.servidor && relojRed() - sesion.ultimoEnvio >= INTERVALO_HOLA) {
+        paqueteRed hola = {};
+        hola.tipo = PAQUETE_HOLA;
+        enviarPaquete(sesion, hola);
+    }
+    recibirRed(sesion);
+    return sesion.estado == RED_CONECTADA;
+}
+
+
+// Manda las entradas propias que el otro todavia no confirmo, de la mas vieja a la mas nueva
+inline void enviarEntradas(sesionRed& sesion) {
+    if (sesion.estado != RED_CONECTADA) return;
+    paqueteRed paquete = {};
+    paquete.tipo = PAQUETE_ENTRADAS;
+    paquete.primerPaso = sesion.confirmadoPorRemoto + 1;
+    if (paquete.primerPaso < sesion.paso - HISTORIAL_RED / 2) paquete.primerPaso = sesion.paso - HISTORIAL_RED / 2;
+    int cantidad = sesion.paso - paquete.primerPaso;
+    paquete.cantidad = (uint8_t)(cantidad < 0 ? 0 : cantidad > ENTRADAS_POR_PAQUETE ? ENTRADAS_POR_PAQUETE : cantidad);
+    for (int i = 0; i < paquete.cantidad; i++) paquete.entradas[i] = sesion.local[indiceRed(paquete.primerPaso + i)];
+    paquete.ultimoRecibido = sesion.ultimoRemoto;
+    int ventaja = sesion.paso - 1 - sesion.ultimoRemoto;
+    paquete.ventaja = (int8_t)(ventaja > 127 ? 127 : ventaja);
+
+    paquete.pasoVerificado = pasoVerificable(sesion);
+    if (paquete.pasoVerificado >= 0) paquete.suma = sumaEstado(sesion.estados[indiceRed(paquete.pasoVerificado)]);
+    enviarPaquete(sesion, paquete);
+}
+
+
+// Sin noticias del otro por mucho tiempo la partida se termina
+inline bool redPerdida(const sesionRed& sesion) {
+    return sesion.estado == RED_PERDIDA || (sesion.estado == RED_CONECTADA && relojRed() - sesion.ultimaRecepcion > TIEMPO_SIN_RESPUESTA);
+}
+
+
+// No se puede simular mas alla de lo que el historial deja corregir
+inline bool puedeAvanzarRed(const sesionRed& sesion) {
+    return sesion.paso - sesion.ultimoRemoto <= MAXIMO_ROLLBACK;
+}
+
+
+// Si vamos mas adelantados que el otro conviene esperar un paso para que el rollback no crezca
+inline bool convieneEsperarRed(const sesionRed& sesion) {
+    int ventaja = sesion.paso - 1 - sesion.ultimoRemoto;
+    return ventaja - sesion.ventajaRemota >= 2;
+}
+
+
+// Entrada del otro para un paso: la real si llego, si no la ultima conocida
+inline entradaJugador prediccionRemota(sesionRed& sesion, int32_t paso) {
+    if (paso > sesion.ultimoRemoto) {
+        entradaJugador prediccion = {};
+        if (sesion.ultimoRemoto >= 0) prediccion = sesion.remota[indiceRed(sesion.ultimoRemoto)];
+        sesion.remota[indiceRed(paso)] = prediccion;
+    }
+    return sesion.remota[indiceRed(paso)];
+}
+
+
+inline eventos simularPasoRed(sesionRed& sesion, estadoSimulacion& estado, int32_t paso) {
+    entradaJugador remota = prediccionRemota(sesion, paso);
+    const entradaJugador& local = sesion.local[indiceRed(paso)];
+    entradasPaso teclas = sesion.lado == LADO_IZQUIERDO ? combinarEntradas(local, remota) : combinarEntradas(remota, local);
+    return avanzarSimulacion(estado, teclas, PASO_SIMULACION);
+}
+
+
+// Si llego una entrada distinta de la predicha, vuelve a ese paso y simula de nuevo hasta el presente
+inline void corregirRed(sesionRed& sesion, estadoSimulacion& estado) {
+    if (sesion.corregirDesde < 0) return;
+    int32_t desde = sesion.corregirDesde;
+    sesion.corregirDesde = -1;
+    if (desde < sesion.paso - HISTORIAL_RED + 1) desde = sesion.paso - HISTORIAL_RED + 1;
+
+    estado = sesion.estados[indiceRed(desde)];
+    for (int32_t paso = desde; paso < sesion.paso; paso++) {
+        guardarEstadoRed(sesion, paso, estado);
+        simularPasoRed(sesion, estado, paso);
+    }
+    sesion.rollbacks++;
+    sesion.pasosResimulados += sesion.paso - desde;
+}
+
+
+// Un paso nuevo con la entrada local; los eventos son los de la prediccion
+inline eventos avanzarRed(sesionRed& sesion, estadoSimulacion& estado, const entradaJugador& local) {
+    int32_t paso = sesion.paso;
+    guardarEstadoRed(sesion, paso, estado);
+    sesion.local[indiceRed(paso)] = local;
+    eventos ocurrido = simularPasoRed(sesion, estado, paso);
+    sesion.paso++;
+    return ocurrido;
+}
+
+
+// Entradas reales de los dos en un paso que ya no puede cambiar (paso <= ultimoRemoto)
+inline entradasPaso entradasConfirmadas(const sesionRed& sesion, int32_t paso) {
+    const entradaJugador& local = sesion.local[indiceRed(paso)];
+    const entradaJugador& remota = sesion.remota[indiceRed(paso)];
+    return sesion.lado == LADO_IZQUIERDO ? combinarEntradas(local, remota) : combinarEntradas(remota, local);
+}
+
+
+// Estado despues del ultimo paso que ya tiene las entradas reales de los dos
+inline const estadoSimulacion& estadoConfirmado(const sesionRed& sesion, const estadoSimulacion& actual) {
+    int32_t confirmado = sesion.ultimoRemoto + 1;
+    return confirmado >= sesion.paso ? actual : sesion.estados[indiceRed(confirmado)];
+}
+
+
+// Prueba sin ventana: dos procesos juegan con teclas al azar por la red (directo o a traves de
+// proxy_red) y al final imprimen la suma del estado en el mismo paso, que tiene que coincidir.
+// pong --headless --servidor [puerto] | pong --headless --conectar host:puerto  [--pasos N] [--semilla S]
+inline int ejecutarRedSinVentana(int argc, char* argv[]) {
+    sesionRed sesion;
+    const char* conectar = nullptr;
+    uint16_t puerto = PUERTO_RED;
+    bool servidor = false;
+    int32_t pasos = 1800;
+    uint32_t azar = 1;
+    for (int i = 1; i < argc; i++) {
+        const char* valor = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(argv[i], "--servidor")) {
+            servidor = true;
+            if (valor && valor[0] != '-') puerto = (uint16_t)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--conectar") && valor) conectar = argv[++i];
+        else if (!strcmp(argv[i], "--pasos") && valor) pasos = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--semilla") && valor) azar = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    }
+    if (servidor ? !iniciarServidor(sesion, puerto) : !conectar || !iniciarCliente(sesion, conectar)) {
+        return 1;
+    }
+    azar = azar * 2 + sesion.lado + 1;
+
+    double limite = relojRed() + 30.0;
+    while (!conectarRed(sesion)) {
+        if (relojRed() > limite) {
+            fprintf(stderr, "Nadie se conecto\n");
+            cerrarRed(sesion);
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    estadoSimulacion estado;
+    inicializarSimulacion(estado);
+    empezarPartidaRed(sesion, estado);
+
+    entradaJugador teclas = {};
+    double anterior = relojRed(), acumulador = 0, terminado = 0;
+    while (true) {
+        double ahora = relojRed();
+        acumulador += ahora - anterior;
+        anterior = ahora;
+
+        recibirRed(sesion);
+        corregirRed(sesion, estado);
+        if (redPerdida(sesion) && sesion.ultimoRemoto < pasos - 1) {
+            fprintf(stderr, "Se perdio la conexion en el paso %d\n", sesion.paso);
+            cerrarRed(sesion);
+            return 1;
+        }
+
+        bool espero = false;
+        while (acumulador >= PASO_SIMULACION && sesion.paso < pasos) {
+            acumulador -= PASO_SIMULACION;
+            if (!puedeAvanzarRed(sesion) || (!espero && convieneEsperarRed(sesion))) {
+                espero = true;
+                continue;
+            }
+            // Teclas nuevas cada cuarto de segundo, con fracciones para probar los toques cortos
+            if (sesion.paso % 30 == 0) {
+                for (int i = 0; i < 4; i++) teclas.presionada[i] = (siguienteAzar(azar) & 3) == 0 ? (uint8_t)siguienteAzar(azar) : 0;
+            }
+            avanzarRed(sesion, estado, teclas);
+        }
+        enviarEntradas(sesion);
+
+        // Con todas las entradas del otro el estado ya es definitivo; se sigue enviando un rato
+        // para que al otro le lleguen las nuestras
+        if (sesion.paso >= pasos && sesion.ultimoRemoto >= pasos - 1) {
+            if (!terminado) terminado = ahora;
+            if (ahora - terminado > 1.0 || sesion.confirmadoPorRemoto >= pasos - 1) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    printf("paso %d suma %08x puntaje %d-%d rollbacks %d resimulados %lld%s\n", sesion.paso, sumaEstado(estado),
+        estado.paletaIzquierda.puntaje, estado.paletaDerecha.puntaje, sesion.rollbacks, sesion.pasosResimulados,
+        sesion.desincronizada ? " DESINCRONIZADA" : "");
+    bool desincronizada = sesion.desincronizada;
+    // Un poco mas de tiempo para repetir las ultimas entradas por si se perdieron
+    double hasta = relojRed() + 0.5;
+    while (relojRed() < hasta) {
+        recibirRed(sesion);
+        enviarEntradas(sesion);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    cerrarRed(sesion);
+    return desincronizada ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <string.h>
+#include "simulacion.h"
+
+// Variantes del juego. Cada una es un tipo con las reglas de reglasClasicas que cambia; la simulacion se
+// instancia para cada tipo (avanzarSimulacionCon<R>) con sus numeros y sus ramas resueltas al compilar.
+// El menu y las repeticiones eligen en tiempo de ejecucion con REGISTRO_REGLAS: se elige una vez por
+// partida y cada paso llama directo a la version ya especializada.
+// La IA, el modo caos y la simulacion por lotes suponen el alto de la cancha, las paletas y la pelota
+// clasicos, asi que las variantes no los cambian (lo revisa registrarReglas).
+
+
+// Cancha 1.5 veces mas ancha; la pelota va mas rapido para que cada cruce dure parecido
+struct reglasCanchaAncha : reglasClasicas {
+    static constexpr float ANCHO = 1800;
+    static constexpr float VELOCIDAD_PELOTA = 650;
+    static constexpr float VELOCIDAD_MAXIMA_PELOTA = 650;
+};
+
+
+// Cada golpe de paleta acelera la pelota un 8%, hasta el doble de lo normal
+struct reglasAceleradas : reglasClasicas {
+    static constexpr float ACELERACION_GOLPE = 1.08f;
+    static constexpr float VELOCIDAD_MAXIMA_PELOTA = 2 * reglasClasicas::VELOCIDAD_PELOTA;
+    static constexpr int PUNTAJE_GANADOR = 7;
+};
+
+
+// Cada jugador tiene una paleta delantera en su mitad que se mueve en espejo con la suya
+struct reglasCuatroPaletas : reglasClasicas {
+    static constexpr bool CUATRO_PALETAS = true;
+    static constexpr float DISTANCIA_DELANTERA = 300;
+};
+
+
+enum modoReglas : uint8_t { REGLAS_CLASICAS, REGLAS_CANCHA_ANCHA, REGLAS_ACELERADAS, REGLAS_CUATRO_PALETAS, TOTAL_REGLAS };
+
+
+// Una variante elegida en tiempo de ejecucion: sus funciones ya instanciadas y lo que hace falta para dibujarla
+struct juegoReglas {
+    const char* nombre; // Para el menu
+    const char* clave; // Para la linea de comandos y el benchmark
+    eventos (*avanzar)(estadoSimulacion& estado, const entradasPaso& teclas, float dt, float* impacto);
+    void (*inicializar)(estadoSimulacion& estado);
+    void (*nuevaPartida)(estadoSimulacion& estado);
+    void (*delanteras)(const estadoSimulacion& estado, paleta& izquierda, paleta& derecha); // nullptr con dos paletas
+    float ancho, alto; // Cancha
+};
+
+
+template <class R>
+void delanterasCon(const estadoSimulacion& estado, paleta& izquierda, paleta& derecha) {
+    izquierda = paletaDelanteraCon<R>(estado.paletaIzquierda, false);
+    derecha = paletaDelanteraCon<R>(estado.paletaDerecha, true);
+}
+
+
+template <class R>
+constexpr juegoReglas registrarReglas(const char* nombre, const char* clave) {
+    static_assert(R::ALTO == reglasClasicas::ALTO && R::ALTURA_PALETA == reglasClasicas::ALTURA_PALETA &&
+        R::ANCHO_PALETA == reglasClasicas::ANCHO_PALETA && R::TAMANIO_PELOTA == reglasClasicas::TAMANIO_PELOTA &&
+        R::VELOCIDAD_PALETA == reglasClasicas::VELOCIDAD_PALETA, "La IA supone el alto de la cancha y las paletas clasicas");
+    return { nombre, clave, avanzarSimulacionCon<R>, inicializarSimulacionCon<R>, nuevaPartidaCon<R>,
+        R::CUATRO_PALETAS ? delanterasCon<R> : nullptr, R::ANCHO, R::ALTO };
+}
+
+
+// En el orden de modoReglas
+const juegoReglas REGISTRO_REGLAS[TOTAL_REGLAS] = {
+    registrarReglas<reglasClasicas>("Clasico", "clasico"),
+    registrarReglas<reglasCanchaAncha>("Cancha ancha", "ancha"),
+    registrarReglas<reglasAceleradas>("Acelerado", "acelerado"),
+    registrarReglas<reglasCuatroPaletas>("Cuatro paletas", "cuatro"),
+};
+
+
+// Llama a f(R(), modo) con cada variante, para lo que necesita el tipo y no solo el registro (el benchmark)
+template <typename F>
+void paraCadaReglas(F f) {
+    f(reglasClasicas(), REGLAS_CLASICAS);
+    f(reglasCanchaAncha(), REGLAS_CANCHA_ANCHA);
+    f(reglasAceleradas(), REGLAS_ACELERADAS);
+    f(reglasCuatroPaletas(), REGLAS_CUATRO_PALETAS);
+}
+
+
+inline bool buscarReglas(const char* clave, modoReglas& modo) {
+    for (int i = 0; i < TOTAL_REGLAS; i++) {
+        if (!strcmp(REGISTRO_REGLAS[i].clave, clave)) {
+            modo = (modoReglas)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,473 @@
+#pragma once
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "reglas.h"
+
+// Repeticiones: se guardan las teclas de cada paso y, cada PASOS_POR_CLAVE pasos, el estado completo
+// (cuadro clave). Cada segmento es un cuadro clave mas las teclas que siguen, y se puede decodificar solo,
+// asi para ir a cualquier momento se busca su segmento y se simulan a lo sumo PASOS_POR_CLAVE pasos.
+// El hilo principal solo codifica en memoria; otro hilo escribe los segmentos al disco.
+//
+// Archivo: cabecera (firma, version, pasos por cuadro clave y variante de reglas), segmentos y al final
+// un indice con la posicion de cada segmento. Si el juego se cerro sin escribir el indice, se recorre el
+// archivo segmento por segmento.
+// Segmento: largo, primer paso, cantidad de pasos (varints), el estado en XOR con el estado inicial
+// (varints, casi todo ceros) y las teclas como corridas: mascara de teclas que cambiaron, sus valores
+// y cuantos pasos seguidos se usan.
+
+
+const char FIRMA_REPETICION[8] = { 'P', 'O', 'N', 'G', 'R', 'E', 'P', '1' };
+const char FIRMA_INDICE_REPETICION[8] = { 'P', 'O', 'N', 'G', 'I', 'D', 'X', '1' };
+const uint32_t VERSION_REPETICION = 2; // La 1 no guardaba las reglas: siempre son las clasicas
+const int PASOS_POR_CLAVE = 120; // Un cuadro clave por segundo de juego
+const int CAMPOS_ESTADO = 11;
+const int VELOCIDAD_MAXIMA_REPETICION = 64;
+
+
+// Codificacion
+
+inline void agregarVarint(std::vector<uint8_t>& datos, uint64_t valor) {
+    while (valor >= 0x80) {
+        datos.push_back((uint8_t)(valor | 0x80));
+        valor >>= 7;
+    }
+    datos.push_back((uint8_t)valor);
+}
+
+
+inline bool leerVarint(const uint8_t*& cursor, const uint8_t* fin, uint64_t& valor) {
+    valor = 0;
+    for (int desplazamiento = 0; desplazamiento < 64 && cursor < fin; desplazamiento += 7) {
+        uint8_t byte = *cursor++;
+        valor |= (uint64_t)(byte & 0x7F) << desplazamiento;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+
+// El estado como 11 palabras de 32 bits, los flotantes bit a bit
+inline void camposEstado(const estadoSimulacion& estado, uint32_t campos[CAMPOS_ESTADO]) {
+    const float flotantes[] = { estado.paletaIzquierda.x, estado.paletaIzquierda.y, estado.paletaDerecha.x, estado.paletaDerecha.y,
+        estado.pelota.x, estado.pelota.y, estado.pelota.vx, estado.pelota.vy };
+    memcpy(campos, flotantes, sizeof(flotantes));
+    campos[8] = (uint32_t)estado.paletaIzquierda.puntaje;
+    campos[9] = (uint32_t)estado.paletaDerecha.puntaje;
+    campos[10] = estado.ganador;
+}
+
+
+inline void estadoDeCampos(const uint32_t campos[CAMPOS_ESTADO], estadoSimulacion& estado) {
+    float flotantes[8];
+    memcpy(flotantes, campos, sizeof(flotantes));
+    estado.paletaIzquierda.x = flotantes[0];
+    estado.paletaIzquierda.y = flotantes[1];
+    estado.paletaDerecha.x = flotantes[2];
+    estado.paletaDerecha.y = flotantes[3];
+    estado.pelota.x = flotantes[4];
+    estado.pelota.y = flotantes[5];
+    estado.pelota.vx = flotantes[6];
+    estado.pelota.vy = flotantes[7];
+    estado.paletaIzquierda.puntaje = (int)campos[8];
+    estado.paletaDerecha.puntaje = (int)campos[9];
+    estado.ganador = (uint8_t)campos[10];
+}
+
+
+// Referencia para el XOR de los cuadros clave: no depende de otro cuadro, asi cada segmento se lee solo
+inline void camposBase(uint32_t campos[CAMPOS_ESTADO]) {
+    estadoSimulacion base;
+    inicializarSimulacion(base);
+    camposEstado(base, campos);
+}
+
+
+// Grabacion
+
+struct grabadorRepeticion {
+    // Compartido con el hilo que escribe
+    FILE* archivo = nullptr;
+    std::thread hilo;
+    std::mutex candado;
+    std::condition_variable aviso;
+    std::vector<std::vector<uint8_t>> pendientes;
+    bool terminar = false;
+
+    // Solo el hilo principal
+    bool activo = false;
+    int32_t paso = 0; // Proximo paso a grabar
+    uint64_t posicion = 0; // Bytes ya entregados al hilo
+    std::vector<uint64_t> indice; // Posicion de cada segmento
+    std::vector<uint8_t> cuerpo; // Segmento en construccion, sin su encabezado
+    int32_t primerPasoSegmento = 0;
+    int pasosSegmento = 0;
+    entradasPaso actual; // Teclas de la corrida abierta
+    entradasPaso anterior; // Teclas de la corrida anterior, para la mascara de cambios
+    uint64_t largoCorrida = 0;
+};
+
+
+inline void hiloGrabador(grabadorRepeticion* grabador) {
+    std::vector<std::vector<uint8_t>> lote;
+    while (true) {
+        bool terminar;
+        {
+            std::unique_lock<std::mutex> bloqueo(grabador->candado);
+            grabador->aviso.wait(bloqueo, [grabador]() { return grabador->terminar || !grabador->pendientes.empty(); });
+            lote.swap(grabador->pendientes);
+            terminar = grabador->terminar;
+        }
+        for (const std::vector<uint8_t>& datos : lote) fwrite(datos.data(), 1, datos.size(), grabador->archivo);
+        lote.clear();
+        fflush(grabador->archivo);
+        if (terminar) break;
+    }
+    fclose(grabador->archivo);
+    grabador->archivo = nullptr;
+}
+
+
+// Entrega bytes al hilo que escribe; solo toma el candado para agregarlos a la cola
+inline void entregarBytes(grabadorRepeticion& grabador, std::vector<uint8_t>& datos) {
+    grabador.posicion += datos.size();
+    {
+        std::lock_guard<std::mutex> bloqueo(grabador.candado);
+        grabador.pendientes.push_back(std::move(datos));
+    }
+    grabador.aviso.notify_one();
+    datos.clear();
+}
+
+
+// Crea nombre.rep sin pisar otro archivo: si ya existe (otra mesa empezo en el mismo segundo) prueba
+// nombre-2.rep, nombre-3.rep ... La creacion es exclusiva, asi dos grabadores nunca abren el mismo archivo
+const int MAXIMO_NOMBRES_REPETICION = 100;
+
+
+inline bool iniciarGrabacion(grabadorRepeticion& grabador, const char* nombre, modoReglas reglas = REGLAS_CLASICAS) {
+    char ruta[256];
+    grabador.archivo = nullptr;
+    for (int intento = 1; !grabador.archivo && intento <= MAXIMO_NOMBRES_REPETICION; intento++) {
+        if (intento == 1) snprintf(ruta, sizeof(ruta), "%s.rep", nombre);
+        else snprintf(ruta, sizeof(ruta), "%s-%d.rep", nombre, intento);
+        grabador.archivo = fopen(ruta, "wbx");
+        if (!grabador.archivo && errno != EEXIST) break;
+    }
+    if (!grabador.archivo) {
+        fprintf(stderr, "Error creando %s\n", ruta);
+        return false;
+    }
+    grabador.activo = true;
+    grabador.terminar = false;
+    grabador.paso = 0;
+    grabador.posicion = 0;
+    grabador.indice.clear();
+    grabador.cuerpo.clear();
+    grabador.pasosSegmento = 0;
+
+    std::vector<uint8_t> cabecera(FIRMA_REPETICION, FIRMA_REPETICION + 8);
+    agregarVarint(cabecera, VERSION_REPETICION);
+    agregarVarint(cabecera, PASOS_POR_CLAVE);
+    agregarVarint(cabecera, reglas);
+    grabador.hilo = std::thread(hiloGrabador, &grabador);
+    entregarBytes(grabador, cabecera);
+    return true;
+}
+
+
+inline void cerrarCorrida(grabadorRepeticion& grabador) {
+    if (!grabador.largoCorrida) return;
+    uint8_t mascara = 0;
+    for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) {
+        if (grabador.actual.presionada[tecla] != grabador.anterior.presionada[tecla]) mascara |= 1 << tecla;
+    }
+    grabador.cuerpo.push_back(mascara);
+    for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) {
+        if (mascara & (1 << tecla)) grabador.cuerpo.push_back(grabador.actual.presionada[tecla]);
+    }
+    agregarVarint(grabador.cuerpo, grabador.largoCorrida);
+    grabador.anterior = grabador.actual;
+    grabador.largoCorrida = 0;
+}
+
+
+// Cierra el segmento: encabezado delante del cuerpo y a la cola del hilo
+inline void cerrarSegmento(grabadorRepeticion& grabador) {
+    cerrarCorrida(grabador);
+    std::vector<uint8_t> encabezado;
+    agregarVarint(encabezado, (uint64_t)grabador.primerPasoSegmento);
+    agregarVarint(encabezado, (uint64_t)grabador.pasosSegmento);
+
+    std::vector<uint8_t> segmento;
+    agregarVarint(segmento, encabezado.size() + grabador.cuerpo.size());
+    segmento.insert(segmento.end(), encabezado.begin(), encabezado.end());
+    segmento.insert(segmento.end(), grabador.cuerpo.begin(), grabador.cuerpo.end());
+    grabador.indice.push_back(grabador.posicion);
+    entregarBytes(grabador, segmento);
+    grabador.cuerpo.clear();
+    grabador.pasosSegmento = 0;
+}
+
+
+// Empieza un segmento con el estado antes del paso que sigue
+inline void abrirSegmento(grabadorRepeticion& grabador, const estadoSimulacion& estado) {
+    uint32_t campos[CAMPOS_ESTADO], base[CAMPOS_ESTADO];
+    camposEstado(estado, campos);
+    camposBase(base);
+    for (int i = 0; i < CAMPOS_ESTADO; i++) agregarVarint(grabador.cuerpo, campos[i] ^ base[i]);
+    grabador.primerPasoSegmento = grabador.paso;
+    memset(&grabador.actual, 0, sizeof(grabador.actual));
+    memset(&grabador.anterior, 0, sizeof(grabador.anterior));
+    grabador.largoCorrida = 0;
+}
+
+
+// Graba un paso: estado es el de antes de simularlo y teclas las que se usaron
+inline void grabarPaso(grabadorRepeticion& grabador, const estadoSimulacion& estado, const entradasPaso& teclas) {
+    if (!grabador.activo) return;
+    if (grabador.pasosSegmento == 0) abrirSegmento(grabador, estado);
+    if (grabador.largoCorrida && memcmp(&teclas, &grabador.actual, sizeof(teclas)) != 0) cerrarCorrida(grabador);
+    grabador.actual = teclas;
+    grabador.largoCorrida++;
+    grabador.pasosSegmento++;
+    grabador.paso++;
+    if (grabador.pasosSegmento == PASOS_POR_CLAVE) cerrarSegmento(grabador);
+}
+
+
+// Ultimo segmento con el estado final y sin pasos (sirve para verificar), el indice, y espera al hilo
+inline void terminarGrabacion(grabadorRepeticion& grabador, const estadoSimulacion& final) {
+    if (!grabador.activo) return;
+    if (grabador.pasosSegmento > 0) cerrarSegmento(grabador);
+    abrirSegmento(grabador, final);
+    cerrarSegmento(grabador);
+
+    // Indice: cantidad y posiciones en 64 bits, despues donde empieza y la firma
+    std::vector<uint8_t> indice;
+    uint64_t inicioIndice = grabador.posicion;
+    uint64_t cantidad = grabador.indice.size();
+    indice.insert(indice.end(), (const uint8_t*)&cantidad, (const uint8_t*)&cantidad + 8);
+    indice.insert(indice.end(), (const uint8_t*)grabador.indice.data(), (const uint8_t*)(grabador.indice.data() + cantidad));
+    indice.insert(indice.end(), (const uint8_t*)&inicioIndice, (const uint8_t*)&inicioIndice + 8);
+    indice.insert(indice.end(), FIRMA_INDICE_REPETICION, FIRMA_INDICE_REPETICION + 8);
+    entregarBytes(grabador, indice);
+
+    {
+        std::lock_guard<std::mutex> bloqueo(grabador.candado);
+        grabador.terminar = true;
+    }
+    grabador.aviso.notify_one();
+    grabador.hilo.join();
+    grabador.activo = false;
+}
+
+
+// Lectura
+
+struct segmentoRepeticion {
+    size_t teclas; // Donde empiezan las corridas de teclas
+    size_t fin;
+    int32_t primerPaso;
+    int32_t pasos;
+    uint32_t clave[CAMPOS_ESTADO]; // Estado al empezar el segmento
+};
+
+
+struct repeticionCargada {
+    std::vector<uint8_t> datos;
+    std::vector<segmentoRepeticion> segmentos;
+    int32_t totalPasos = 0;
+    modoReglas reglas = REGLAS_CLASICAS;
+};
+
+
+struct reproductorRepeticion {
+    estadoSimulacion estado;
+    int32_t paso = 0;
+    int segmento = 0;
+    size_t cursor = 0;
+    entradasPaso teclas;
+    uint64_t restantes = 0; // Pasos que quedan de la corrida actual
+};
+
+
+// Lee el encabezado y el cuadro clave de un segmento; devuelve el comienzo del siguiente o 0 si esta roto
+inline size_t leerSegmento(const repeticionCargada& repeticion, size_t posicion, segmentoRepeticion& segmento) {
+    const uint8_t* cursor = repeticion.datos.data() + posicion;
+    const uint8_t* fin = repeticion.datos.data() + repeticion.datos.size();
+    uint64_t largo, primerPaso, pasos;
+    if (!leerVarint(cursor, fin, largo) || largo > (uint64_t)(fin - cursor)) return 0;
+    const uint8_t* finSegmento = cursor + largo;
+    if (!leerVarint(cursor, finSegmento, primerPaso) || !leerVarint(cursor, finSegmento, pasos)) return 0;
+
+    uint32_t base[CAMPOS_ESTADO];
+    camposBase(base);
+    for (int i = 0; i < CAMPOS_ESTADO; i++) {
+        uint64_t valor;
+        if (!leerVarint(cursor, finSegmento, valor)) return 0;
+        segmento.clave[i] = (uint32_t)valor ^ base[i];
+    }
+    segmento.primerPaso = (int32_t)primerPaso;
+    segmento.pasos = (int32_t)pasos;
+    segmento.teclas = cursor - repeticion.datos.data();
+    segmento.fin = finSegmento - repeticion.datos.data();
+    return segmento.fin;
+}
+
+
+inline bool abrirRepeticion(const char* ruta, repeticionCargada& repeticion) {
+    FILE* archivo = fopen(ruta, "rb");
+    if (!archivo) {
+        fprintf(stderr, "Error abriendo %s\n", ruta);
+        return false;
+    }
+    fseek(archivo, 0, SEEK_END);
+    long tamanio = ftell(archivo);
+    fseek(archivo, 0, SEEK_SET);
+    repeticion.datos.resize(tamanio > 0 ? (size_t)tamanio : 0);
+    bool leido = fread(repeticion.datos.data(), 1, repeticion.datos.size(), archivo) == repeticion.datos.size();
+    fclose(archivo);
+
+    const std::vector<uint8_t>& datos = repeticion.datos;
+    const uint8_t* cursor = datos.data() + 8;
+    const uint8_t* fin = datos.data() + datos.size();
+    uint64_t version, pasosPorClave, reglas = REGLAS_CLASICAS;
+    if (!leido || datos.size() < 10 || memcmp(datos.data(), FIRMA_REPETICION, 8) != 0 ||
+        !leerVarint(cursor, fin, version) || !leerVarint(cursor, fin, pasosPorClave) || version < 1 ||
+        version > VERSION_REPETICION || (version >= 2 && !leerVarint(cursor, fin, reglas)) || reglas >= TOTAL_REGLAS) {
+        fprintf(stderr, "%s no es una repeticion valida\n", ruta);
+        return false;
+    }
+    repeticion.reglas = (modoReglas)reglas;
+
+    // Con indice se salta directo a cada segmento; sin indice (grabacion cortada) se recorren en orden
+    std::vector<uint64_t> posiciones;
+    size_t finSegmentos = datos.size();
+    if (datos.size() >= 24 && memcmp(fin - 8, FIRMA_INDICE_REPETICION, 8) == 0) {
+        uint64_t inicioIndice, cantidad;
+        memcpy(&inicioIndice, fin - 16, 8);
+        if (inicioIndice + 8 <= datos.size() - 16) {
+            memcpy(&cantidad, datos.data() + inicioIndice, 8);
+            if (cantidad <= (datos.size() - 16 - inicioIndice - 8) / 8) {
+                posiciones.resize((size_t)cantidad);
+                memcpy(posiciones.data(), datos.data() + inicioIndice + 8, (size_t)cantidad * 8);
+                finSegmentos = (size_t)inicioIndice;
+            }
+        }
+    }
+    if (posiciones.empty()) {
+        size_t posicion = cursor - datos.data();
+        segmentoRepeticion segmento;
+        while (posicion < finSegmentos) {
+            size_t siguiente = leerSegmento(repeticion, posicion, segmento);
+            if (!siguiente) break;
+            posiciones.push_back(posicion);
+            posicion = siguiente;
+        }
+    }
+
+    repeticion.segmentos.clear();
+    for (uint64_t posicion : posiciones) {
+        segmentoRepeticion segmento;
+        if (posicion >= finSegmentos || !leerSegmento(repeticion, (size_t)posicion, segmento)) break;
+        repeticion.segmentos.push_back(segmento);
+    }
+    if (repeticion.segmentos.empty()) {
+        fprintf(stderr, "%s no tiene ningun segmento completo\n", ruta);
+        return false;
+    }
+    const segmentoRepeticion& ultimo = repeticion.segmentos.back();
+    repeticion.totalPasos = ultimo.primerPaso + ultimo.pasos;
+    return true;
+}
+
+
+inline void empezarSegmento(const repeticionCargada& repeticion, reproductorRepeticion& reproductor, int indice) {
+    reproductor.segmento = indice;
+    reproductor.cursor = repeticion.segmentos[indice].teclas;
+    memset(&reproductor.teclas, 0, sizeof(reproductor.teclas));
+    reproductor.restantes = 0;
+}
+
+
+// Teclas del proximo paso; false si la repeticion termino o esta rota
+inline bool siguientesTeclas(const repeticionCargada& repeticion, reproductorRepeticion& reproductor, entradasPaso& teclas) {
+    while (reproductor.restantes == 0) {
+        const segmentoRepeticion* segmento = &repeticion.segmentos[reproductor.segmento];
+        if (reproductor.cursor >= segmento->fin) {
+            if (reproductor.segmento + 1 >= (int)repeticion.segmentos.size()) return false;
+            empezarSegmento(repeticion, reproductor, reproductor.segmento + 1);
+            continue;
+        }
+        const uint8_t* cursor = repeticion.datos.data() + reproductor.cursor;
+        const uint8_t* fin = repeticion.datos.data() + segmento->fin;
+        uint8_t mascara = *cursor++;
+        for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) {
+            if (!(mascara & (1 << tecla))) continue;
+            if (cursor >= fin) return false;
+            reproductor.teclas.presionada[tecla] = *cursor++;
+        }
+        if (!leerVarint(cursor, fin, reproductor.restantes)) return false;
+        reproductor.cursor = cursor - repeticion.datos.data();
+    }
+    reproductor.restantes--;
+    teclas = reproductor.teclas;
+    return true;
+}
+
+
+// Simula un paso de la repeticion; false al llegar al final
+inline bool avanzarRepeticion(const repeticionCargada& repeticion, reproductorRepeticion& reproductor) {
+    entradasPaso teclas;
+    if (reproductor.paso >= repeticion.totalPasos || !siguientesTeclas(repeticion, reproductor, teclas)) return false;
+    REGISTRO_REGLAS[repeticion.reglas].avanzar(reproductor.estado, teclas, PASO_SIMULACION, nullptr);
+    reproductor.paso++;
+    return true;
+}
+
+
+// Va a cualquier paso: el cuadro clave de su segmento y a lo sumo PASOS_POR_CLAVE pasos simulados
+inline void irAPaso(const repeticionCargada& repeticion, reproductorRepeticion& reproductor, int32_t paso) {
+    if (paso < 0) paso = 0;
+    if (paso > repeticion.totalPasos) paso = repeticion.totalPasos;
+    int bajo = 0, alto = (int)repeticion.segmentos.size() - 1;
+    while (bajo < alto) {
+        int medio = (bajo + alto + 1) / 2;
+        if (repeticion.segmentos[medio].primerPaso <= paso) bajo = medio;
+        else alto = medio - 1;
+    }
+    const segmentoRepeticion& segmento = repeticion.segmentos[bajo];
+    estadoDeCampos(segmento.clave, reproductor.estado);
+    reproductor.paso = segmento.primerPaso;
+    empezarSegmento(repeticion, reproductor, bajo);
+    while (reproductor.paso < paso && avanzarRepeticion(repeticion, reproductor)) {}
+}
+
+
+// Simula la repeticion entera desde el primer cuadro clave y compara con cada uno de los siguientes
+inline int verificarRepeticion(const char* ruta) {
+    repeticionCargada repeticion;
+    if (!abrirRepeticion(ruta, repeticion)) return 1;
+    reproductorRepeticion reproductor;
+    irAPaso(repeticion, reproductor, 0);
+
+    for (size_t i = 1; i < repeticion.segmentos.size(); i++) {
+        const segmentoRepeticion& segmento = repeticion.segmentos[i];
+        while (reproductor.paso < segmento.primerPaso && avanzarRepeticion(repeticion, reproductor)) {}
+        uint32_t simulado[CAMPOS_ESTADO];
+        camposEstado(reproductor.estado, simulado);
+        if (reproductor.paso != segmento.primerPaso || memcmp(simulado, segmento.clave, sizeof(simulado)) != 0) {
+            printf("%s: no coincide en el paso %d (segmento %d)\n", ruta, segmento.primerPaso, (int)i);
+            return 1;
+        }
+    }
+    printf("%s: %d pasos, %d cuadros clave, %zu bytes, coincide\n", ruta, repeticion.totalPasos,
+        (int)repeticion.segmentos.size(), repeticion.datos.size());
+    return 0;
+}
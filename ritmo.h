@@ -0,0 +1,190 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <stdio.h>
+
+// Ritmo de frames: decide cuando empieza cada vuelta del bucle para que los frames salgan parejos.
+// - RITMO_VSYNC: SDL_RenderPresent espera al refresco del monitor; aca se mide el refresco real (la
+//   mediana de los intervalos entre presentaciones) para saber cuando se salteo uno.
+// - RITMO_FIJO: cada frame tiene un plazo (el anterior mas el periodo, no "ahora mas el periodo", asi el
+//   error no se acumula). Se duerme con SDL_Delay hasta poco antes y el resto se espera mirando el
+//   contador, porque SDL_Delay se pasa de 1 a 2 ms segun el sistema. Ese margen se ajusta solo.
+// En los menus (inactivo) cualquier modo baja a FPS_INACTIVO.
+// Si el renderer no tiene vsync, o el driver lo ignora y las presentaciones no esperan, RITMO_VSYNC seria un
+// bucle sin freno: se pasa a RITMO_FIJO al refresco del monitor.
+// Un plazo perdido es un frame que salio al menos medio periodo tarde (en vsync: que se salteo un refresco).
+
+
+enum modoRitmo { RITMO_VSYNC, RITMO_FIJO };
+
+
+const double FPS_INACTIVO = 30;
+const double REFRESCO_POR_DEFECTO = 60; // Si el monitor no informa el suyo
+const int MUESTRAS_REFRESCO = 120;
+const double MARGEN_ESPERA_MINIMO = 0.0005;
+const double MARGEN_ESPERA_MAXIMO = 0.004;
+const int PRESENTACIONES_SIN_VSYNC = 30; // Seguidas y en menos de medio refresco: el driver no espera
+
+
+struct ritmoFrames {
+    modoRitmo modo = RITMO_VSYNC;
+    double fpsObjetivo = 0; // Solo RITMO_FIJO
+    double refresco = REFRESCO_POR_DEFECTO; // Hz, medido con los intervalos entre presentaciones
+    double refrescoInformado = REFRESCO_POR_DEFECTO; // Hz, lo que dice el monitor
+    Uint64 frecuencia = 1;
+
+    Uint64 proximoPlazo = 0; // Contador en el que deberia empezar el proximo frame
+    Uint64 ultimaPresentacion = 0;
+    double intervalos[MUESTRAS_REFRESCO] = {};
+    int muestras = 0;
+    double margenEspera = 0.002; // Cuanto antes del plazo se deja de dormir y se empieza a mirar el contador
+    int presentacionesRapidas = 0; // Seguidas, en menos de medio refresco
+    bool inactivo = false;
+
+    // Plazos perdidos, para el panel y para quien los quiera contar
+    long long frames = 0;
+    long long plazosPerdidos = 0;
+    double peorRetraso = 0; // Segundos
+    double ultimoRetraso = 0;
+};
+
+
+// Resumen para mostrar o registrar
+struct resumenRitmo {
+    long long frames;
+    long long plazosPerdidos;
+    double peorRetrasoMs;
+    double refrescoHz;
+    double periodoMs; // El del modo actual
+};
+
+
+// Periodo de un frame en segundos segun el modo y si esta en un menu
+inline double periodoRitmo(const ritmoFrames& ritmo) {
+    if (ritmo.inactivo) return 1.0 / FPS_INACTIVO;
+    if (ritmo.modo == RITMO_FIJO && ritmo.fpsObjetivo > 0) return 1.0 / ritmo.fpsObjetivo;
+    return 1.0 / ritmo.refresco;
+}
+
+
+// Deja de confiar en SDL_RenderPresent y espera cada frame al refresco del monitor
+inline void pasarARitmoFijo(ritmoFrames& ritmo, const char* motivo) {
+    fprintf(stderr, "%s, se usan %.0f FPS fijos\n", motivo, ritmo.refrescoInformado);
+    ritmo.modo = RITMO_FIJO;
+    ritmo.fpsObjetivo = ritmo.refrescoInformado;
+    ritmo.refresco = ritmo.refrescoInformado;
+    ritmo.proximoPlazo = SDL_GetPerformanceCounter();
+}
+
+
+// fps <= 0 es vsync; el renderer se tiene que crear con SDL_RENDERER_PRESENTVSYNC solo en ese caso
+inline void iniciarRitmo(ritmoFrames& ritmo, SDL_Window* ventana, SDL_Renderer* renderizador, double fps) {
+    ritmo.modo = fps > 0 ? RITMO_FIJO : RITMO_VSYNC;
+    ritmo.fpsObjetivo = fps;
+    ritmo.frecuencia = SDL_GetPerformanceFrequency();
+    SDL_DisplayMode modo;
+    if (SDL_GetWindowDisplayMode(ventana, &modo) == 0 && modo.refresh_rate > 0) ritmo.refrescoInformado = modo.refresh_rate;
+    ritmo.refresco = ritmo.refrescoInformado;
+    ritmo.proximoPlazo = SDL_GetPerformanceCounter();
+    ritmo.ultimaPresentacion = 0;
+    ritmo.muestras = 0;
+    ritmo.presentacionesRapidas = 0;
+
+    SDL_RendererInfo informacion;
+    if (ritmo.modo == RITMO_VSYNC && (SDL_GetRendererInfo(renderizador, &informacion) != 0 || !(informacion.flags & SDL_RENDERER_PRESENTVSYNC))) {
+        pasarARitmoFijo(ritmo, "El renderer no tiene vsync");
+    }
+}
+
+
+inline void anotarPlazoPerdido(ritmoFrames& ritmo, double retraso) {
+    ritmo.plazosPerdidos++;
+    ritmo.ultimoRetraso = retraso;
+    if (retraso > ritmo.peorRetraso) ritmo.peorRetraso = retraso;
+}
+
+
+// Duerme hasta el margen y espera el resto mirando el contador; el margen sigue a lo que se pasa SDL_Delay
+inline void esperarHasta(ritmoFrames& ritmo, Uint64 plazo) {
+    Uint64 ahora = SDL_GetPerformanceCounter();
+    double falta = plazo > ahora ? (double)(plazo - ahora) / ritmo.frecuencia : 0;
+    if (falta > ritmo.margenEspera) {
+        Uint32 milisegundos = (Uint32)((falta - ritmo.margenEspera) * 1000);
+        if (milisegundos > 0) {
+            SDL_Delay(milisegundos);
+            double dormido = (double)(SDL_GetPerformanceCounter() - ahora) / ritmo.frecuencia;
+            double sobra = dormido - milisegundos / 1000.0;
+            ritmo.margenEspera = std::clamp(std::max(ritmo.margenEspera * 0.98, sobra + 0.0002), MARGEN_ESPERA_MINIMO, MARGEN_ESPERA_MAXIMO);
+        }
+    }
+    while (SDL_GetPerformanceCounter() < plazo) {}
+}
+
+
+// Al empezar cada vuelta del bucle. inactivo: la pantalla es un menu y alcanza con FPS_INACTIVO
+inline void esperarFrame(ritmoFrames& ritmo, bool inactivo) {
+    bool cambio = inactivo != ritmo.inactivo;
+    ritmo.inactivo = inactivo;
+    ritmo.frames++;
+
+    // El intervalo que cruza el cambio no es de ninguno de los dos ritmos
+    if (cambio) ritmo.ultimaPresentacion = 0;
+
+    // Con vsync en partida espera SDL_RenderPresent
+    if (ritmo.modo == RITMO_VSYNC && !inactivo) return;
+
+    Uint64 periodo = (Uint64)(periodoRitmo(ritmo) * ritmo.frecuencia);
+    Uint64 ahora = SDL_GetPerformanceCounter();
+    if (cambio) ritmo.proximoPlazo = ahora;
+    if (ahora > ritmo.proximoPlazo) {
+        // Tarde: medio periodo o mas es un plazo perdido; mas de un periodo ya no se recupera, se vuelve a
+        // enganchar desde ahora en vez de correr varios frames seguidos para alcanzar
+        Uint64 retraso = ahora - ritmo.proximoPlazo;
+        if (retraso * 2 >= periodo && !inactivo) anotarPlazoPerdido(ritmo, (double)retraso / ritmo.frecuencia);
+        if (retraso >= periodo) ritmo.proximoPlazo = ahora;
+    }
+    else {
+        esperarHasta(ritmo, ritmo.proximoPlazo);
+    }
+    ritmo.proximoPlazo += periodo;
+}
+
+
+// Despues de SDL_RenderPresent: mide el intervalo real y, con vsync, el refresco y los refrescos salteados
+inline void registrarPresentacionRitmo(ritmoFrames& ritmo) {
+    Uint64 ahora = SDL_GetPerformanceCounter();
+    Uint64 anterior = ritmo.ultimaPresentacion;
+    ritmo.ultimaPresentacion = ahora;
+    if (!anterior || ritmo.modo != RITMO_VSYNC || ritmo.inactivo) return;
+
+    double intervalo = (double)(ahora - anterior) / ritmo.frecuencia;
+    double periodo = 1.0 / ritmo.refresco;
+
+    // Presentaciones que no esperan al refresco: el driver ignora el vsync
+    double nominal = 1.0 / ritmo.refrescoInformado;
+    ritmo.presentacionesRapidas = intervalo < nominal * 0.5 ? ritmo.presentacionesRapidas + 1 : 0;
+    if (ritmo.presentacionesRapidas >= PRESENTACIONES_SIN_VSYNC) {
+        pasarARitmoFijo(ritmo, "SDL_RenderPresent no espera al refresco");
+        return;
+    }
+
+    // Solo los intervalos de un refresco sirven para medirlo; los demas son refrescos perdidos
+    if (intervalo > nominal * 0.75 && intervalo < nominal * 1.25) {
+        ritmo.intervalos[ritmo.muestras++ % MUESTRAS_REFRESCO] = intervalo;
+        int cantidad = std::min(ritmo.muestras, MUESTRAS_REFRESCO);
+        if (cantidad >= 16) {
+            double ordenados[MUESTRAS_REFRESCO];
+            std::copy(ritmo.intervalos, ritmo.intervalos + cantidad, ordenados);
+            std::nth_element(ordenados, ordenados + cantidad / 2, ordenados + cantidad);
+            ritmo.refresco = 1.0 / ordenados[cantidad / 2];
+        }
+    }
+    else if (intervalo >= periodo * 1.5) {
+        anotarPlazoPerdido(ritmo, intervalo - periodo);
+    }
+}
+
+
+inline resumenRitmo resumirRitmo(const ritmoFrames& ritmo) {
+    return { ritmo.frames, ritmo.plazosPerdidos, ritmo.peorRetraso * 1000, ritmo.refresco, periodoRitmo(ritmo) * 1000 };
+}
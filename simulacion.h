@@ -0,0 +1,311 @@
+#pragma once
+#include <math.h>
+#include <stdint.h>
+#include "colision.h"
+
+// Simulacion del juego sin nada de SDL: misma entrada y mismo paso dan siempre el mismo resultado
+
+
+// Dimensiones de la ventana
+const int ANCHO_VENTANA = 1200;
+const int ALTURA_VENTANA = 650;
+
+// Dimensiones de las paletas y la pelota
+const int ANCHO_PALETA = 15;
+const int ALTURA_PALETA = 90;
+const int TAMANIO_PELOTA = 10;
+
+
+// Velocidades
+const int VELOCIDAD_PALETA = 400; // Pxeles por segundo
+const int VELOCIDAD_PELOTA = 500;   // Pxeles por segundo
+
+
+// Lmite de puntuacin para ganar
+const int PUNTAJE_GANADOR = 5;
+
+
+// Paso fijo de la simulacion (120 pasos por segundo)
+const float PASO_SIMULACION = 1.0f / 120.0f;
+
+
+// Medidas de la cancha para el nucleo de colisiones
+const geometriaColision GEOMETRIA_CANCHA = { 0, ALTURA_VENTANA - TAMANIO_PELOTA, TAMANIO_PELOTA, ANCHO_PALETA, ALTURA_PALETA };
+
+
+// Reglas del juego clasico. Las variantes (reglas.h) son tipos con los mismos nombres: la simulacion se
+// instancia una vez por variante con sus numeros como constantes, asi el paso no pregunta el modo.
+struct reglasClasicas {
+    static constexpr float ANCHO = ANCHO_VENTANA; // Cancha
+    static constexpr float ALTO = ALTURA_VENTANA;
+    static constexpr float ANCHO_PALETA = ::ANCHO_PALETA;
+    static constexpr float ALTURA_PALETA = ::ALTURA_PALETA;
+    static constexpr float TAMANIO_PELOTA = ::TAMANIO_PELOTA;
+    static constexpr float VELOCIDAD_PALETA = ::VELOCIDAD_PALETA;
+    static constexpr float VELOCIDAD_PELOTA = ::VELOCIDAD_PELOTA;
+    static constexpr int PUNTAJE_GANADOR = ::PUNTAJE_GANADOR;
+    static constexpr float DISTANCIA_BORDE = 50; // De la paleta al fondo de su lado al empezar
+
+    // La pelota se multiplica por esto en cada golpe de paleta, hasta VELOCIDAD_MAXIMA_PELOTA en x
+    static constexpr float ACELERACION_GOLPE = 1;
+    static constexpr float VELOCIDAD_MAXIMA_PELOTA = ::VELOCIDAD_PELOTA;
+
+    // Cada jugador con una segunda paleta DISTANCIA_DELANTERA mas adelante que se mueve en espejo
+    static constexpr bool CUATRO_PALETAS = false;
+    static constexpr float DISTANCIA_DELANTERA = 0;
+};
+
+
+// Teclas que estan presionadas durante un paso, una por bit
+enum teclaEntrada : uint8_t {
+    IZQUIERDA_ARRIBA = 1 << 0, // W
+    IZQUIERDA_ABAJO = 1 << 1, // S
+    IZQUIERDA_IZQUIERDA = 1 << 2, // A
+    IZQUIERDA_DERECHA = 1 << 3, // D
+    DERECHA_ARRIBA = 1 << 4, // Flecha arriba
+    DERECHA_ABAJO = 1 << 5, // Flecha abajo
+    DERECHA_IZQUIERDA = 1 << 6, // Flecha izquierda
+    DERECHA_DERECHA = 1 << 7 // Flecha derecha
+};
+typedef uint8_t entradas;
+const int TOTAL_TECLAS = 8;
+
+
+// Cuanto de un paso estuvo presionada cada tecla (indice = bit de teclaEntrada), en 255avos.
+// Con el teclado con marcas de tiempo una tecla puede estar apretada solo parte del paso.
+struct entradasPaso {
+    uint8_t presionada[TOTAL_TECLAS];
+};
+
+
+// Las teclas presionadas durante todo el paso, como las arma la IA o la simulacion por lotes
+inline entradasPaso entradasCompletas(entradas teclas) {
+    entradasPaso paso;
+    for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) paso.presionada[tecla] = (teclas >> tecla) & 1 ? 255 : 0;
+    return paso;
+}
+
+
+inline float fraccionTecla(const entradasPaso& paso, teclaEntrada tecla) {
+    int indice = 0;
+    while ((1 << indice) != tecla) indice++;
+    return paso.presionada[indice] / 255.0f;
+}
+
+
+// Lo que paso durante un paso, para que el juego toque sonidos o cambie de estado
+enum eventoSimulacion : uint8_t {
+    EVENTO_REBOTE = 1 << 0, // La pelota toco una pared o una paleta
+    EVENTO_PUNTO_IZQUIERDA = 1 << 1, // Anoto el jugador izquierdo
+    EVENTO_PUNTO_DERECHA = 1 << 2, // Anoto el jugador derecho
+    EVENTO_FIN_PARTIDA = 1 << 3 // Alguien llego a PUNTAJE_GANADOR
+};
+typedef uint8_t eventos;
+
+
+enum ganadorPartida : uint8_t { NINGUNO, GANA_IZQUIERDA, GANA_DERECHA };
+
+
+struct paleta {
+    float x, y;
+    int puntaje;
+};
+
+
+struct pelota {
+    float x, y;
+    float vx, vy;
+};
+
+
+// Todo lo que hace falta para simular una partida
+struct estadoSimulacion {
+    paleta paletaIzquierda;
+    paleta paletaDerecha;
+    ::pelota pelota;
+    uint8_t ganador;
+};
+
+
+// Generador xorshift, rapido y con el mismo resultado en cualquier maquina
+inline uint32_t siguienteAzar(uint32_t& estado) {
+    estado ^= estado << 13;
+    estado ^= estado >> 17;
+    estado ^= estado << 5;
+    return estado;
+}
+
+
+// Numero entre -1 y 1
+inline float azarCentrado(uint32_t& estado) {
+    return (float)(siguienteAzar(estado) & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+
+// Pone la pelota en el centro saliendo hacia el lado indicado (1 derecha, -1 izquierda)
+template <class R>
+inline void reiniciarPelotaCon(pelota& bola, int direccion) {
+    bola.x = R::ANCHO / 2;
+    bola.y = R::ALTO / 2;
+    bola.vx = direccion * R::VELOCIDAD_PELOTA;
+    bola.vy = R::VELOCIDAD_PELOTA;
+}
+
+
+// Paletas en su lugar de salida y pelota en el centro
+template <class R>
+inline void inicializarSimulacionCon(estadoSimulacion& estado) {
+    estado.paletaIzquierda = { R::DISTANCIA_BORDE, R::ALTO / 2 - R::ALTURA_PALETA / 2, 0 };
+    estado.paletaDerecha = { R::ANCHO - R::DISTANCIA_BORDE - R::ANCHO_PALETA, R::ALTO / 2 - R::ALTURA_PALETA / 2, 0 };
+    reiniciarPelotaCon<R>(estado.pelota, 1);
+    estado.ganador = NINGUNO;
+}
+
+
+// Reinicia puntajes y pelota, las paletas se quedan donde estan
+template <class R>
+inline void nuevaPartidaCon(estadoSimulacion& estado) {
+    estado.paletaIzquierda.puntaje = 0;
+    estado.paletaDerecha.puntaje = 0;
+    reiniciarPelotaCon<R>(estado.pelota, 1);
+    estado.ganador = NINGUNO;
+}
+
+
+// Paleta delantera de un jugador: DISTANCIA_DELANTERA hacia el centro y en espejo de arriba a abajo
+template <class R>
+inline paleta paletaDelanteraCon(const paleta& trasera, bool derecha) {
+    return { derecha ? trasera.x - R::DISTANCIA_DELANTERA : trasera.x + R::DISTANCIA_DELANTERA, R::ALTO - R::ALTURA_PALETA - trasera.y, 0 };
+}
+
+
+// Mueve una paleta segun sus cuatro teclas, sin pasarse de su mitad de la cancha
+// Cada direccion recibe la fraccion del paso (0 a 1) que estuvo presionada su tecla
+template <class R>
+inline void moverPaletaCon(paleta& p, float arriba, float abajo, float izquierda, float derecha, float minimoX, float maximoX, float dt) {
+    float distancia = R::VELOCIDAD_PALETA * dt;
+    if (arriba > 0 && p.y > 0) p.y -= distancia * arriba;
+    if (abajo > 0 && p.y < R::ALTO - R::ALTURA_PALETA) p.y += distancia * abajo;
+    if (izquierda > 0 && p.x > minimoX) p.x -= distancia * izquierda;
+    if (derecha > 0 && p.x < maximoX) p.x += distancia * derecha;
+}
+
+
+// Mueve las dos paletas segun cuanto del paso estuvo presionada cada tecla.
+// Con cuatro paletas las traseras se frenan antes, para que las delanteras no pasen la mitad
+template <class R>
+inline void moverPaletasCon(estadoSimulacion& estado, const entradasPaso& paso, float dt) {
+    constexpr float maximoIzquierdaX = R::ANCHO / 2 - R::ANCHO_PALETA - R::DISTANCIA_DELANTERA;
+    constexpr float minimoDerechaX = R::ANCHO / 2 + R::DISTANCIA_DELANTERA;
+    moverPaletaCon<R>(estado.paletaIzquierda, fraccionTecla(paso, IZQUIERDA_ARRIBA), fraccionTecla(paso, IZQUIERDA_ABAJO),
+        fraccionTecla(paso, IZQUIERDA_IZQUIERDA), fraccionTecla(paso, IZQUIERDA_DERECHA), 0, maximoIzquierdaX, dt);
+    moverPaletaCon<R>(estado.paletaDerecha, fraccionTecla(paso, DERECHA_ARRIBA), fraccionTecla(paso, DERECHA_ABAJO),
+        fraccionTecla(paso, DERECHA_IZQUIERDA), fraccionTecla(paso, DERECHA_DERECHA), minimoDerechaX, R::ANCHO - R::ANCHO_PALETA, dt);
+}
+
+
+// Avanza la simulacion un paso de dt segundos, devuelve lo que paso.
+// impacto (opcional): segundos desde el inicio del paso hasta el primer rebote, -1 si no hubo
+template <class R>
+inline eventos avanzarSimulacionCon(estadoSimulacion& estado, const entradasPaso& teclas, float dt, float* impacto = nullptr) {
+    constexpr geometriaColision geometria = { 0, R::ALTO - R::TAMANIO_PELOTA, R::TAMANIO_PELOTA, R::ANCHO_PALETA, R::ALTURA_PALETA };
+    eventos ocurrido = 0;
+    if (impacto) *impacto = -1;
+    if (estado.ganador != NINGUNO) return ocurrido;
+
+    // Mover paleta izquierda (W/S/A/D) y derecha (flechas)
+    moverPaletasCon<R>(estado, teclas, dt);
+
+    // Mover pelota con colision continua: rebota en el primer contacto aunque el paso sea largo
+    pelota& bola = estado.pelota;
+    uint8_t golpes = 0;
+    pelotasColision pelotas = { &bola.x, &bola.y, &bola.vx, &bola.vy, &golpes, impacto, 1 };
+    paletasColision paletas = { &estado.paletaIzquierda.x, &estado.paletaIzquierda.y, &estado.paletaDerecha.x, &estado.paletaDerecha.y };
+    if constexpr (R::CUATRO_PALETAS) {
+        paleta izquierda = paletaDelanteraCon<R>(estado.paletaIzquierda, false);
+        paleta derecha = paletaDelanteraCon<R>(estado.paletaDerecha, true);
+        paletasColision delanteras = { &izquierda.x, &izquierda.y, &derecha.x, &derecha.y };
+        barrerPelotasCuatro(pelotas, paletas, delanteras, geometria, dt);
+    }
+    else {
+        barrerPelotas(pelotas, paletas, geometria, dt);
+    }
+    if (golpes) ocurrido |= EVENTO_REBOTE;
+
+    // La pelota se acelera con cada golpe de paleta; vx y vy igual, asi no cambia el angulo
+    if constexpr (R::ACELERACION_GOLPE != 1) {
+        if (golpes & (GOLPE_PALETA_IZQUIERDA | GOLPE_PALETA_DERECHA)) {
+            float factor = R::VELOCIDAD_MAXIMA_PELOTA / fabsf(bola.vx);
+            if (factor > R::ACELERACION_GOLPE) factor = R::ACELERACION_GOLPE;
+            if (factor > 1) {
+                bola.vx *= factor;
+                bola.vy *= factor;
+            }
+        }
+    }
+
+    // Puntuacin y reinicio de pelota
+    if (bola.x + R::TAMANIO_PELOTA < 0) {
+        estado.paletaDerecha.puntaje++;
+        reiniciarPelotaCon<R>(bola, 1);
+        ocurrido |= EVENTO_PUNTO_DERECHA;
+        if (estado.paletaDerecha.puntaje >= R::PUNTAJE_GANADOR) {
+            estado.ganador = GANA_DERECHA;
+            ocurrido |= EVENTO_FIN_PARTIDA;
+        }
+    }
+    else if (bola.x > R::ANCHO) {
+        estado.paletaIzquierda.puntaje++;
+        reiniciarPelotaCon<R>(bola, -1);
+        ocurrido |= EVENTO_PUNTO_IZQUIERDA;
+        if (estado.paletaIzquierda.puntaje >= R::PUNTAJE_GANADOR) {
+            estado.ganador = GANA_IZQUIERDA;
+            ocurrido |= EVENTO_FIN_PARTIDA;
+        }
+    }
+
+    return ocurrido;
+}
+
+
+// El juego clasico: lo usan la partida en linea, las repeticiones viejas, el modo caos y los lotes
+
+inline void reiniciarPelota(pelota& bola, int direccion) {
+    reiniciarPelotaCon<reglasClasicas>(bola, direccion);
+}
+
+
+inline void inicializarSimulacion(estadoSimulacion& estado) {
+    inicializarSimulacionCon<reglasClasicas>(estado);
+}
+
+
+inline void nuevaPartida(estadoSimulacion& estado) {
+    nuevaPartidaCon<reglasClasicas>(estado);
+}
+
+
+inline void moverPaletas(estadoSimulacion& estado, const entradasPaso& paso, float dt) {
+    moverPaletasCon<reglasClasicas>(estado, paso, dt);
+}
+
+
+inline void moverPaletas(estadoSimulacion& estado, entradas teclas, float dt) {
+    moverPaletas(estado, entradasCompletas(teclas), dt);
+}
+
+
+inline eventos avanzarSimulacion(estadoSimulacion& estado, const entradasPaso& teclas, float dt, float* impacto = nullptr) {
+    return avanzarSimulacionCon<reglasClasicas>(estado, teclas, dt, impacto);
+}
+
+
+inline eventos avanzarSimulacion(estadoSimulacion& estado, entradas teclas, float dt) {
+    return avanzarSimulacion(estado, entradasCompletas(teclas), dt);
+}
+
+
+// Mezcla dos posiciones para dibujar entre un paso y el siguiente
+inline float interpolar(float anterior, float actual, float alfa) {
+    return anterior + (actual - anterior) * alfa;
+}
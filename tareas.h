@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos con robo de trabajo para correr varias partidas a la vez. Cada hilo tiene su cola: saca
+// del final de la suya (lo ultimo que le tocaron) y, si esta vacia, roba del principio de la de otro.
+// El hilo que reparte tambien trabaja (es la cola 0) hasta que se terminan todas las tareas de la ronda,
+// asi con una sola partida no se usa ningun hilo extra.
+
+
+struct tarea {
+    void (*funcion)(void* datos) = nullptr;
+    void* datos = nullptr;
+};
+
+
+struct colaTareas {
+    std::mutex candado;
+    std::deque<tarea> tareas;
+};
+
+
+struct poolTareas {
+    std::unique_ptr<colaTareas[]> colas; // La 0 es del hilo que reparte
+    int cantidadColas = 0;
+    int siguienteCola = 0; // Reparto en ronda
+    std::vector<std::thread> hilos;
+    std::mutex candado; // Para dormir y despertar a los hilos
+    std::condition_variable aviso; // Hay tareas o hay que terminar
+    std::condition_variable terminadas; // Se hizo la ultima tarea de la ronda
+    std::atomic<int> enCola{ 0 }; // Tareas que nadie tomo todavia
+    std::atomic<int> pendientes{ 0 }; // Tareas de la ronda sin terminar
+    std::atomic<long long> robadas{ 0 }; // Tareas hechas por un hilo que no era el de su cola
+    bool terminar = false;
+};
+
+
+// Saca una tarea de la cola propia o, si esta vacia, le roba a otra
+inline bool tomarTarea(poolTareas& pool, int propia, tarea& resultado) {
+    {
+        colaTareas& cola = pool.colas[propia];
+        std::lock_guard<std::mutex> bloqueo(cola.candado);
+        if (!cola.tareas.empty()) {
+            resultado = cola.tareas.back();
+            cola.tareas.pop_back();
+            pool.enCola--;
+            return true;
+        }
+    }
+    for (int i = 1; i < pool.cantidadColas; i++) {
+        colaTareas& cola = pool.colas[(propia + i) % pool.cantidadColas];
+        std::lock_guard<std::mutex> bloqueo(cola.candado);
+        if (!cola.tareas.empty()) {
+            resultado = cola.tareas.front();
+            cola.tareas.pop_front();
+            pool.enCola--;
+            pool.robadas++;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+inline void hacerTarea(poolTareas& pool, const tarea& trabajo) {
+    trabajo.funcion(trabajo.datos);
+    if (--pool.pendientes == 0) {
+        std::lock_guard<std::mutex> bloqueo(pool.candado);
+        pool.terminadas.notify_all();
+    }
+}
+
+
+inline void hiloTareas(poolTareas* pool, int propia) {
+    for (;;) {
+        tarea trabajo;
+        if (tomarTarea(*pool, propia, trabajo)) {
+            hacerTarea(*pool, trabajo);
+            continue;
+        }
+        std::unique_lock<std::mutex> bloqueo(pool->candado);
+        pool->aviso.wait(bloqueo, [&]() { return pool->terminar || pool->enCola > 0; });
+        if (pool->terminar) return;
+    }
+}
+
+
+// hilos: cuantos hilos ademas del que reparte (0 hace todo en el que llama)
+inline void iniciarPool(poolTareas& pool, int hilos) {
+    pool.cantidadColas = hilos + 1;
+    pool.colas.reset(new colaTareas[pool.cantidadColas]);
+    pool.terminar = false;
+    for (int i = 1; i <= hilos; i++) pool.hilos.emplace_back(hiloTareas, &pool, i);
+}
+
+
+// Agrega una tarea a la ronda; empieza a correr con ejecutarTareas
+inline void encolarTarea(poolTareas& pool, tarea trabajo) {
+    colaTareas& cola = pool.colas[pool.siguienteCola];
+    pool.siguienteCola = (pool.siguienteCola + 1) % pool.cantidadColas;
+    pool.pendientes++;
+    std::lock_guard<std::mutex> bloqueo(cola.candado);
+    cola.tareas.push_back(trabajo);
+    pool.enCola++;
+}
+
+
+// Despierta a los hilos, trabaja con ellos y vuelve cuando se hicieron todas las tareas encoladas
+inline void ejecutarTareas(poolTareas& pool) {
+    if (pool.pendientes == 0) return;
+    {
+        std::lock_guard<std::mutex> bloqueo(pool.candado);
+        pool.aviso.notify_all();
+    }
+    tarea trabajo;
+    while (tomarTarea(pool, 0, trabajo)) hacerTarea(pool, trabajo);
+    std::unique_lock<std::mutex> bloqueo(pool.candado);
+    pool.terminadas.wait(bloqueo, [&]() { return pool.pendientes == 0; });
+}
+
+
+inline void cerrarPool(poolTareas& pool) {
+    {
+        std::lock_guard<std::mutex> bloqueo(pool.candado);
+        pool.terminar = true;
+        pool.aviso.notify_all();
+    }
+    for (std::thread& hilo : pool.hilos) hilo.join();
+    pool.hilos.clear();
+}
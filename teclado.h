@@ -0,0 +1,139 @@
+#pragma once
+#include <SDL.h>
+#include <string.h>
+#include "simulacion.h"
+
+// Teclado con marcas de tiempo: cada SDL_KEYDOWN/SDL_KEYUP se guarda con el momento en que ocurrio
+// y cada paso de simulacion recibe que fraccion del paso estuvo presionada cada tecla. Asi un toque
+// mas corto que un frame igual mueve la paleta, y el movimiento no depende de los frames por segundo.
+// Los tiempos son segundos del contador de alto rendimiento; SDL marca los eventos en milisegundos.
+
+
+const int MAXIMO_CAMBIOS_TECLADO = 256;
+const int MUESTRAS_LATENCIA = 120;
+
+
+struct cambioTecla {
+    double tiempo;
+    Uint64 contador;
+    uint8_t tecla; // teclaEntrada
+    bool presionada;
+};
+
+
+struct tecladoConTiempo {
+    cambioTecla cambios[MAXIMO_CAMBIOS_TECLADO];
+    int cantidad = 0;
+    entradas sostenidas = 0; // Teclas presionadas al inicio del proximo paso
+    bool activo = false; // Se sincronizo con el teclado al empezar la partida
+
+    // Latencia desde el evento hasta que SDL_RenderPresent devolvio el frame que lo muestra
+    Uint64 cambioSinMostrar = 0; // Contador del cambio mas viejo que ya se simulo y no se mostro
+    double latencias[MUESTRAS_LATENCIA] = {};
+    int muestrasLatencia = 0;
+};
+
+
+inline uint8_t teclaDeEscaneo(SDL_Scancode codigo) {
+    switch (codigo) {
+    case SDL_SCANCODE_W: return IZQUIERDA_ARRIBA;
+    case SDL_SCANCODE_S: return IZQUIERDA_ABAJO;
+    case SDL_SCANCODE_A: return IZQUIERDA_IZQUIERDA;
+    case SDL_SCANCODE_D: return IZQUIERDA_DERECHA;
+    case SDL_SCANCODE_UP: return DERECHA_ARRIBA;
+    case SDL_SCANCODE_DOWN: return DERECHA_ABAJO;
+    case SDL_SCANCODE_LEFT: return DERECHA_IZQUIERDA;
+    case SDL_SCANCODE_RIGHT: return DERECHA_DERECHA;
+    default: return 0;
+    }
+}
+
+
+// Empieza de cero con las teclas que ya estan apretadas
+inline void reiniciarTeclado(tecladoConTiempo& teclado, entradas sostenidas) {
+    teclado.cantidad = 0;
+    teclado.sostenidas = sostenidas;
+    teclado.cambioSinMostrar = 0;
+}
+
+
+// Guarda un cambio de tecla con su hora; las repeticiones automaticas no son cambios
+inline void registrarTecla(tecladoConTiempo& teclado, const SDL_KeyboardEvent& evento) {
+    uint8_t tecla = teclaDeEscaneo(evento.keysym.scancode);
+    if (!tecla || evento.repeat || teclado.cantidad >= MAXIMO_CAMBIOS_TECLADO) return;
+
+    // Pasar la marca de SDL (milisegundos) al contador: cuanto hace que ocurrio, restado de ahora
+    Uint64 ahora = SDL_GetPerformanceCounter();
+    Uint64 frecuencia = SDL_GetPerformanceFrequency();
+    Uint64 atras = (Uint64)(Uint32)(SDL_GetTicks() - evento.timestamp) * frecuencia / 1000;
+    Uint64 contador = atras < ahora ? ahora - atras : 0;
+
+    // Llegan en orden, pero el redondeo a milisegundos no debe desordenarlos
+    double tiempo = (double)contador / frecuencia;
+    if (teclado.cantidad > 0 && tiempo < teclado.cambios[teclado.cantidad - 1].tiempo) {
+        tiempo = teclado.cambios[teclado.cantidad - 1].tiempo;
+    }
+    teclado.cambios[teclado.cantidad++] = { tiempo, contador, tecla, evento.type == SDL_KEYDOWN };
+}
+
+
+// Usa los cambios que caen antes de fin y devuelve cuanto del paso [inicio, fin) estuvo presionada cada tecla
+inline entradasPaso consumirTeclado(tecladoConTiempo& teclado, double inicio, double fin) {
+    double presionado[TOTAL_TECLAS] = {};
+    double cursor = inicio;
+    entradas teclas = teclado.sostenidas;
+
+    int usados = 0;
+    for (; usados < teclado.cantidad && teclado.cambios[usados].tiempo < fin; usados++) {
+        const cambioTecla& cambio = teclado.cambios[usados];
+        // Lo que paso antes del paso (un frame muy largo recortado) cuenta desde el inicio
+        double momento = cambio.tiempo > cursor ? cambio.tiempo : cursor;
+        for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) {
+            if ((teclas >> tecla) & 1) presionado[tecla] += momento - cursor;
+        }
+        cursor = momento;
+        if (cambio.presionada) teclas |= cambio.tecla;
+        else teclas &= ~cambio.tecla;
+        if (!teclado.cambioSinMostrar) teclado.cambioSinMostrar = cambio.contador;
+    }
+    for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) {
+        if ((teclas >> tecla) & 1) presionado[tecla] += fin - cursor;
+    }
+
+    teclado.cantidad -= usados;
+    memmove(teclado.cambios, teclado.cambios + usados, teclado.cantidad * sizeof(cambioTecla));
+    teclado.sostenidas = teclas;
+
+    // Un toque muy corto vale al menos 1/255 del paso, no se pierde
+    entradasPaso paso;
+    for (int tecla = 0; tecla < TOTAL_TECLAS; tecla++) {
+        double fraccion = presionado[tecla] / (fin - inicio);
+        int valor = (int)(fraccion * 255 + 0.5);
+        if (presionado[tecla] > 0 && valor == 0) valor = 1;
+        paso.presionada[tecla] = (uint8_t)(valor > 255 ? 255 : valor);
+    }
+    return paso;
+}
+
+
+// Se llama despues de SDL_RenderPresent: el frame que se acaba de mostrar ya incluye los cambios simulados
+inline void registrarPresentacion(tecladoConTiempo& teclado) {
+    if (!teclado.cambioSinMostrar) return;
+    double latencia = (double)(SDL_GetPerformanceCounter() - teclado.cambioSinMostrar) / SDL_GetPerformanceFrequency();
+    teclado.latencias[teclado.muestrasLatencia++ % MUESTRAS_LATENCIA] = latencia;
+    teclado.cambioSinMostrar = 0;
+}
+
+
+// Promedio y maximo de las ultimas MUESTRAS_LATENCIA mediciones, en milisegundos
+inline void resumirLatencia(const tecladoConTiempo& teclado, double& promedio, double& maxima) {
+    int cantidad = teclado.muestrasLatencia < MUESTRAS_LATENCIA ? teclado.muestrasLatencia : MUESTRAS_LATENCIA;
+    promedio = maxima = 0;
+    for (int i = 0; i < cantidad; i++) {
+        promedio += teclado.latencias[i];
+        if (teclado.latencias[i] > maxima) maxima = teclado.latencias[i];
+    }
+    if (cantidad > 0) promedio /= cantidad;
+    promedio *= 1000;
+    maxima *= 1000;
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <iostream>
+#include <vector>
+
+
+// Rango de caracteres que se rasterizan en el atlas (Latin-1 imprimible)
+const int PRIMER_CARACTER = 32;
+const int ULTIMO_CARACTER = 255;
+const int TOTAL_CARACTERES = ULTIMO_CARACTER - PRIMER_CARACTER + 1;
+
+// Ancho fijo del atlas, el alto se calcula segun la fuente
+const int ANCHO_ATLAS = 512;
+
+// Capacidad inicial del lote (caracteres por frame) para no pedir memoria al dibujar
+const int CARACTERES_POR_LOTE = 1024;
+
+
+// Posicion de un caracter dentro del atlas
+struct glifo {
+    SDL_Rect recorte; // Rectangulo del glifo en la textura del atlas
+    int avance; // Cuanto se mueve el cursor despues de dibujarlo
+};
+
+
+// Todos los glifos de la fuente en una sola textura blanca
+struct atlasTexto {
+    SDL_Texture* textura = nullptr;
+    glifo glifos[TOTAL_CARACTERES] = {};
+    int ancho = 0;
+    int alto = 0;
+};
+
+
+// Texto que ya fue acomodado una vez (menu, instrucciones) y solo se copia al lote
+struct textoFijo {
+    std::vector<SDL_Vertex> vertices; // 4 vertices por caracter, color blanco
+};
+
+
+// Vertices de todo el texto del frame, se dibujan con una sola llamada
+struct loteTexto {
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+
+// Busca el glifo de un caracter, los que no estan en el atlas se dibujan como '?'
+inline const glifo& buscarGlifo(const atlasTexto& atlas, unsigned char caracter) {
+    if (caracter < PRIMER_CARACTER) caracter = '?';
+    return atlas.glifos[caracter - PRIMER_CARACTER];
+}
+
+
+// Rasteriza todos los caracteres de la fuente en una superficie; no usa el renderizador, puede correr en otro hilo
+inline bool rasterizarAtlas(TTF_Font* fuente, atlasTexto& atlas, SDL_Surface*& hoja) {
+    hoja = nullptr;
+    if (!fuente) {
+        std::cerr << "Error: Fuente no cargada para crear el atlas de texto." << std::endl;
+        return false;
+    }
+
+    SDL_Color blanco = { 255, 255, 255, 255 };
+    SDL_Surface* superficies[TOTAL_CARACTERES] = {};
+
+    // Primera pasada: rasterizar cada glifo y acomodarlo en filas
+    int x = 0, y = 0, altoFila = 0;
+    for (int i = 0; i < TOTAL_CARACTERES; i++) {
+        Uint16 caracter = (Uint16)(PRIMER_CARACTER + i);
+        glifo& actual = atlas.glifos[i];
+        actual = {};
+
+        int avance = 0;
+        if (!TTF_GlyphIsProvided(fuente, caracter) || TTF_GlyphMetrics(fuente, caracter, NULL, NULL, NULL, NULL, &avance) < 0) continue;
+
+        // Mismo estilo que TTF_RenderText_Solid, pero convertido a ARGB para mezclar en el atlas
+        SDL_Surface* solido = TTF_RenderGlyph_Solid(fuente, caracter, blanco);
+        if (!solido) continue;
+        superficies[i] = SDL_ConvertSurfaceFormat(solido, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(solido);
+        if (!superficies[i]) continue;
+
+        int w = superficies[i]->w, h = superficies[i]->h;
+        if (x + w > ANCHO_ATLAS) {
+            x = 0;
+            y += altoFila + 1;
+            altoFila = 0;
+        }
+        actual.recorte = { x, y, w, h };
+        actual.avance = avance;
+        x += w + 1;
+        if (h > altoFila) altoFila = h;
+    }
+
+    atlas.ancho = ANCHO_ATLAS;
+    atlas.alto = y + altoFila;
+
+    // Los que no se pudieron rasterizar usan el '?', que ya tiene su lugar
+    for (int i = 0; i < TOTAL_CARACTERES; i++) {
+        if (!superficies[i]) atlas.glifos[i] = atlas.glifos['?' - PRIMER_CARACTER];
+    }
+
+    // Segunda pasada: copiar los glifos a una sola superficie y subirla una vez
+    hoja = SDL_CreateRGBSurfaceWithFormat(0, atlas.ancho, atlas.alto, 32, SDL_PIXELFORMAT_ARGB8888);
+    bool correcto = hoja != nullptr;
+    if (!correcto) std::cerr << "Error creando superficie del atlas: " << SDL_GetError() << std::endl;
+    else SDL_FillRect(hoja, NULL, 0);
+
+    for (int i = 0; i < TOTAL_CARACTERES; i++) {
+        if (!superficies[i]) continue;
+        if (correcto) {
+            SDL_SetSurfaceBlendMode(superficies[i], SDL_BLENDMODE_NONE);
+            SDL_Rect destino = atlas.glifos[i].recorte;
+            if (SDL_BlitSurface(superficies[i], NULL, hoja, &destino) < 0) {
+                std::cerr << "Error copiando un glifo al atlas: " << SDL_GetError() << std::endl;
+                correcto = false;
+            }
+        }
+        SDL_FreeSurface(superficies[i]);
+    }
+    if (!correcto) {
+        SDL_FreeSurface(hoja);
+        hoja = nullptr;
+    }
+    return correcto;
+}
+
+
+// Sube la hoja del atlas a la textura (hilo del renderizador) y la libera, tambien si falla
+inline bool subirAtlas(SDL_Renderer* renderizador, atlasTexto& atlas, SDL_Surface* hoja) {
+    atlas.textura = SDL_CreateTextureFromSurface(renderizador, hoja);
+    SDL_FreeSurface(hoja);
+    if (!atlas.textura) {
+        std::cerr << "Error creando textura del atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    if (SDL_SetTextureBlendMode(atlas.textura, SDL_BLENDMODE_BLEND) < 0) {
+        std::cerr << "Error preparando textura del atlas: " << SDL_GetError() << std::endl;
+        SDL_DestroyTexture(atlas.textura);
+        atlas.textura = nullptr;
+        return false;
+    }
+    return true;
+}
+
+
+// Rasteriza y sube el atlas de una vez
+inline bool crearAtlasTexto(SDL_Renderer* renderizador, TTF_Font* fuente, atlasTexto& atlas) {
+    SDL_Surface* hoja = nullptr;
+    return rasterizarAtlas(fuente, atlas, hoja) && subirAtlas(renderizador, atlas, hoja);
+}
+
+
+// Agrega los 4 vertices de un glifo en la posicion indicada
+inline void agregarGlifo(std::vector<SDL_Vertex>& vertices, const atlasTexto& atlas, const glifo& g, float x, float y, SDL_Color color) {
+    float u0 = (float)g.recorte.x / atlas.ancho;
+    float v0 = (float)g.recorte.y / atlas.alto;
+    float u1 = (float)(g.recorte.x + g.recorte.w) / atlas.ancho;
+    float v1 = (float)(g.recorte.y + g.recorte.h) / atlas.alto;
+    float x1 = x + g.recorte.w;
+    float y1 = y + g.recorte.h;
+
+    vertices.push_back({ { x, y }, color, { u0, v0 } });
+    vertices.push_back({ { x1, y }, color, { u1, v0 } });
+    vertices.push_back({ { x1, y1 }, color, { u1, v1 } });
+    vertices.push_back({ { x, y1 }, color, { u0, v1 } });
+}
+
+
+// Agrega los indices de los dos triangulos de cada caracter nuevo del lote
+inline void completarIndices(loteTexto& lote) {
+    int caracteres = (int)lote.vertices.size() / 4;
+    for (int i = (int)lote.indices.size() / 6; i < caracteres; i++) {
+        int base = i * 4;
+        lote.indices.push_back(base);
+        lote.indices.push_back(base + 1);
+        lote.indices.push_back(base + 2);
+        lote.indices.push_back(base);
+        lote.indices.push_back(base + 2);
+        lote.indices.push_back(base + 3);
+    }
+}
+
+
+// Acomoda un texto fijo una sola vez para no volver a calcularlo cada frame
+inline textoFijo prepararTexto(const atlasTexto& atlas, const char* texto, int x, int y) {
+    textoFijo fijo;
+    SDL_Color blanco = { 255, 255, 255, 255 };
+    float cursor = (float)x;
+    for (const char* c = texto; *c; c++) {
+        const glifo& g = buscarGlifo(atlas, (unsigned char)*c);
+        agregarGlifo(fijo.vertices, atlas, g, cursor, (float)y, blanco);
+        cursor += g.avance;
+    }
+    return fijo;
+}
+
+
+// Prepara el lote con memoria suficiente para un frame normal
+inline void inicializarLote(loteTexto& lote) {
+    lote.vertices.reserve(CARACTERES_POR_LOTE * 4);
+    lote.indices.reserve(CARACTERES_POR_LOTE * 6);
+}
+
+
+// Agrega un texto que cambia (puntaje, mensaje del ganador) al lote del frame
+inline void renderizarTexto(loteTexto& lote, const atlasTexto& atlas, const char* texto, int x, int y, SDL_Color color) {
+    float cursor = (float)x;
+    for (const char* c = texto; *c; c++) {
+        const glifo& g = buscarGlifo(atlas, (unsigned char)*c);
+        agregarGlifo(lote.vertices, atlas, g, cursor, (float)y, color);
+        cursor += g.avance;
+    }
+    completarIndices(lote);
+}
+
+
+// Agrega un texto ya acomodado al lote, solo cambia el color
+inline void renderizarTexto(loteTexto& lote, const textoFijo& fijo, SDL_Color color) {
+    for (SDL_Vertex vertice : fijo.vertices) {
+        vertice.color = color;
+        lote.vertices.push_back(vertice);
+    }
+    completarIndices(lote);
+}
+
+
+// Dibuja todo el texto acumulado con una sola llamada y vacia el lote
+inline void dibujarLoteTexto(SDL_Renderer* renderizador, const atlasTexto& atlas, loteTexto& lote) {
+    if (atlas.textura && !lote.indices.empty()) {
+        SDL_RenderGeometry(renderizador, atlas.textura, lote.vertices.data(), (int)lote.vertices.size(), lote.indices.data(), (int)lote.indices.size());
+    }
+    lote.vertices.clear();
+    lote.indices.clear();
+}
+
+
+// Libera la textura del atlas
+inline void destruirAtlasTexto(atlasTexto& atlas) {
+    if (atlas.textura) SDL_DestroyTexture(atlas.textura);
+    atlas.textura = nullptr;
+}